@@ -1,23 +1,57 @@
 #include <stdlib.h> // malloc, atoi, rand
 #include <stdio.h>
+#include <string.h> // strcmp, memcmp
 #include <assert.h>
 #include <time.h> // time
+#include <limits.h> // INT_MAX
+#include <fcntl.h> // open
+#include <unistd.h> // close
+#include <sys/mman.h> // mmap
+#include <sys/stat.h> // fstat
 
 #define RANDOM_INPUT	1
 #define FILE_INPUT		2
+#define SNAPSHOT_INPUT	3
+
+#define SNAPSHOT_MAGIC	"BST1" // first bytes of a snapshot file
+#define HAS_LEFT		1 // record flag: node has a left child
+#define HAS_RIGHT		2 // record flag: node has a right child
+
+// key distributions of benchmark mode
+#define DIST_UNIFORM	0
+#define DIST_SORTED		1
+#define DIST_REVERSE	2
+#define DIST_ZIPF		3
+#define DIST_CLUSTERED	4
+
+#define ZIPF_RANKS		65536 // max number of zipf buckets
+#define CLUSTER_SIZE	64 // keys drawn around the same center
+#define CLUSTER_WIDTH	256 // spread of keys around a center
+#define DEGENERATE_MAX	20000 // key limit for sorted/reverse, where every operation walks a list
+
+#define ARENA_BLOCK		4096 // number of nodes in an arena block
+#define NIL				0 // index of no node; node 0 of the first block is never used
 
 ////////////////////////////////////////////////////////////////////////////////
 // TREE type definition
+// children are 32-bit indices into the arena instead of pointers (12 bytes per node)
 typedef struct node
 {
-	int			data;
-	struct node	*left;
-	struct node	*right;
+	int				data;
+	unsigned int	left;
+	unsigned int	right;
 } NODE;
 
+// nodes are carved out of blocks of ARENA_BLOCK nodes instead of one malloc per node;
+// node i lives at blocks[i / ARENA_BLOCK][i % ARENA_BLOCK] and never moves
 typedef struct
 {
-	NODE	*root;
+	unsigned int	root;
+	NODE			**blocks;	// arena blocks
+	unsigned int	blockCount;
+	unsigned int	blockCapacity;	// length of the blocks table
+	unsigned int	used;		// index of the next node never handed out
+	unsigned int	freeList;	// deleted nodes linked through right
 } TREE;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -30,12 +64,13 @@ typedef struct
 TREE *BST_Create( void);
 
 /* Deletes all data in tree and recycles memory
+	frees the arena blocks, not the nodes one by one
 */
 void BST_Destroy( TREE *pTree);
 
 /* internal function (not mandatory)
 */
-static void _destroy( NODE *root);
+static void _destroy( TREE *pTree);
 
 /* Inserts new data into the tree
 	return	1 success
@@ -45,9 +80,24 @@ int BST_Insert( TREE *pTree, int data);
 
 /* internal function (not mandatory)
 */
-static void _insert( NODE *root, NODE *newPtr);
+static void _insert( TREE *pTree, unsigned int root, unsigned int newIndex);
 
-NODE *_makeNode( int data);
+/* internal function
+	return	address of the node with the index
+*/
+static NODE *_node( TREE *pTree, unsigned int index);
+
+/* internal function
+	Takes a node from the free list or the arena
+	return	index of the node
+			NIL if overflow
+*/
+static unsigned int _makeNode( TREE *pTree, int data);
+
+/* internal function
+	Returns a node to the free list
+*/
+static void _freeNode( TREE *pTree, unsigned int index);
 
 /* Deletes a node with dltKey from the tree
 	return	1 success
@@ -59,7 +109,7 @@ int BST_Delete( TREE *pTree, int dltKey);
 	success is 1 if deleted; 0 if not
 	return	pointer to root
 */
-static NODE *_delete( NODE *root, int dltKey, int *success);
+static unsigned int _delete( TREE *pTree, unsigned int root, int dltKey, int *success);
 
 /* Retrieve tree for the node containing the requested key
 	return	address of data of the node containing the key
@@ -72,25 +122,116 @@ int *BST_Retrieve( TREE *pTree, int key);
 	return	address of the node containing the key
 			NULL not found
 */
-static NODE *_retrieve( NODE *root, int key);
+static NODE *_retrieve( TREE *pTree, unsigned int root, int key);
 
 /* prints tree using inorder traversal
 */
 void BST_Traverse( TREE *pTree);
-static void _traverse( NODE *root);
+static void _traverse( TREE *pTree, unsigned int root);
+
+/* Visits nodes whose data lies in [lo, hi] in ascending order
+	subtrees entirely outside the range are not visited
+*/
+void BST_RangeTraverse( TREE *pTree, int lo, int hi, void (*callback)(int data));
+static void _rangeTraverse( TREE *pTree, unsigned int root, int lo, int hi, void (*callback)(int data));
+
+/* Deletes all nodes whose data lies in [lo, hi]
+	the tree is split around the range, the middle part is freed and the rest is joined again
+	return	number of deleted nodes
+*/
+int BST_DeleteRange( TREE *pTree, int lo, int hi);
+
+/* internal function
+	Splits the tree into nodes with data < key and nodes with data >= key
+	geRoot receives the root of the (data >= key) part
+	return	root of the (data < key) part
+*/
+static unsigned int _split( TREE *pTree, unsigned int root, int key, unsigned int *geRoot);
+
+/* internal function
+	Frees all nodes of the (sub)tree
+	return	number of freed nodes
+*/
+static int _deleteAll( TREE *pTree, unsigned int root);
+
+/* Prints data followed by a space
+	callback of BST_RangeTraverse
+*/
+static void printNumber( int data);
 
 /* Print tree using inorder right-to-left traversal
 */
 void printTree( TREE *pTree);
 /* internal traversal function
 */
-static void _inorder_print( NODE *root, int level);
+static void _inorder_print( TREE *pTree, unsigned int root, int level);
 
 /* 
 	return 1 if the tree is empty; 0 if not
 */
 int BST_Empty( TREE *pTree);
 
+/*
+	return	height of the tree (0 if empty)
+			-1 overflow
+*/
+int BST_Height( TREE *pTree);
+static int _height( TREE *pTree, unsigned int root);
+
+/*
+	return	bytes of memory held by the tree (head and arena blocks)
+*/
+size_t BST_Memory( TREE *pTree);
+
+/* Writes the tree to a binary snapshot file
+	header: magic (4 bytes), number of nodes (4 bytes, little endian)
+	then one varint per node in preorder: zigzag(data - previous data) << 2 | HAS_LEFT | HAS_RIGHT
+	return	1 success
+			0 file error
+*/
+int BST_Save( TREE *pTree, const char *filename);
+
+/* internal function
+	Writes the preorder records of the (sub)tree
+	return	number of written nodes
+*/
+static unsigned int _save( TREE *pTree, unsigned int root, FILE *fp, int *prev);
+
+/* Rebuilds a tree from a snapshot file written by BST_Save
+	the file is mapped into memory and decoded without comparisons or rebalancing
+	return	tree head pointer
+			NULL if the file is not a valid snapshot or overflow
+*/
+TREE *BST_Load( const char *filename);
+
+/* internal function
+	Decodes the preorder records in [p, end) into pTree
+	return	1 success
+			0 malformed data or overflow
+*/
+static int _load( TREE *pTree, const unsigned char *p, const unsigned char *end, unsigned int count);
+
+////////////////////////////////////////////////////////////////////////////////
+// Benchmark mode
+
+/* xorshift64* pseudo random number generator
+	return	32 random bits
+*/
+static unsigned int _random( void);
+
+/* Fills keys with numbers (1 ~ n * 3) following the given distribution
+	return	1 success
+			0 overflow
+*/
+static int _makeKeys( int *keys, int n, int dist);
+
+/* Inserts, looks up and deletes n keys without printing them
+	and reports throughput, tree height and memory
+	return	0 success
+			1 overflow
+*/
+static int benchmark( int dist, int n);
+
 ////////////////////////////////////////////////////////////////////////////////
 int main( int argc, char **argv)
 {
@@ -98,9 +239,59 @@ int main( int argc, char **argv)
 	TREE *tree;
 	int data;
 	
+	if (argc == 4 && strcmp( argv[1], "-b") == 0)
+	{
+		const char *dists[] = {"uniform", "sorted", "reverse", "zipf", "clustered"};
+		int numbers = atoi(argv[3]);
+
+		for (int dist = DIST_UNIFORM; dist <= DIST_CLUSTERED; dist++)
+		{
+			if (strcmp( argv[2], dists[dist]) == 0 && numbers > 0 && numbers <= INT_MAX / 3)
+			{
+				return benchmark( dist, numbers);
+			}
+		}
+	}
+
+	if (argc == 4 && strcmp( argv[1], "-s") == 0)
+	{
+		// converts a number file into a snapshot
+		FILE *fp = fopen( argv[3], "rt");
+		if (fp == NULL)
+		{
+			fprintf( stderr, "Cannot open file! [%s]\n", argv[3]);
+			return 200;
+		}
+		tree = BST_Create();
+		if (!tree)
+		{
+			printf( "Cannot create a tree!\n");
+			return 100;
+		}
+		int count = 0;
+		while (fscanf( fp, "%d", &data) == 1)
+		{
+			if (!BST_Insert( tree, data)) break;
+			count++;
+		}
+		fclose( fp);
+
+		int ret = BST_Save( tree, argv[2]);
+		BST_Destroy( tree);
+		if (!ret)
+		{
+			fprintf( stderr, "Cannot write snapshot! [%s]\n", argv[2]);
+			return 200;
+		}
+		fprintf( stdout, "%d numbers saved to %s\n", count, argv[2]);
+		return 0;
+	}
+
 	if (argc != 2)
 	{
 		fprintf( stderr, "usage: %s FILE or %s number\n", argv[0], argv[0]);
+		fprintf( stderr, "       %s -b uniform|sorted|reverse|zipf|clustered number\n", argv[0]);
+		fprintf( stderr, "       %s -s SNAPSHOT FILE\n", argv[0]);
 		return 1;
 	}
 	
@@ -110,10 +301,28 @@ int main( int argc, char **argv)
 	{
 		mode = RANDOM_INPUT;
 	}
-	else mode = FILE_INPUT;
+	else if ((tree = BST_Load( argv[1])) != NULL)
+	{
+		fclose( fp);
+		mode = SNAPSHOT_INPUT;
+	}
+	else
+	{
+		char magic[4];
+
+		// a snapshot that fails to decode must not be read as text
+		if (fread( magic, 1, 4, fp) == 4 && memcmp( magic, SNAPSHOT_MAGIC, 4) == 0)
+		{
+			fprintf( stderr, "Cannot load snapshot! [%s]\n", argv[1]);
+			fclose( fp);
+			return 200;
+		}
+		rewind( fp);
+		mode = FILE_INPUT;
+	}
 	
 	// creates a null tree
-	tree = BST_Create();
+	if (mode != SNAPSHOT_INPUT) tree = BST_Create();
 	
 	if (!tree)
 	{
@@ -145,7 +354,7 @@ int main( int argc, char **argv)
 	{
 		fprintf( stdout, "Inserting: ");
 		
-		while (fscanf( fp, "%d", &data) != EOF)
+		while (fscanf( fp, "%d", &data) == 1)
 		{
 			fprintf( stdout, "%d ", data);
 			
@@ -155,6 +364,10 @@ int main( int argc, char **argv)
 		}
 		fclose( fp);
 	}
+	else if (mode == SNAPSHOT_INPUT)
+	{
+		fprintf( stdout, "Loaded snapshot: %s", argv[1]);
+	}
 	
 	fprintf( stdout, "\n");
 
@@ -176,12 +389,21 @@ int main( int argc, char **argv)
 	
 	while (1)
 	{   
-		fprintf( stdout, "Input a number to delete: "); 
-		int num;
-		if (scanf( "%d", &num) == EOF) break;
+		fprintf( stdout, "Input a number to delete (or lo hi to delete a range): "); 
+		char line[256];
+		int num, hi;
+		if (fgets( line, sizeof(line), stdin) == NULL) break;
 		
-		int ret = BST_Delete( tree, num);
-		if (!ret)
+		int inputs = sscanf( line, "%d %d", &num, &hi);
+		if (inputs < 1) continue;
+		if (inputs == 2)
+		{
+			// lists the numbers in the range, then deletes them at once
+			fprintf( stdout, "Range [%d, %d]: ", num, hi);
+			BST_RangeTraverse( tree, num, hi, printNumber);
+			fprintf( stdout, "\n%d deleted\n", BST_DeleteRange( tree, num, hi));
+		}
+		else if (!BST_Delete( tree, num))
 		{
 			fprintf( stdout, "%d not found\n", num);
 			continue;
@@ -212,28 +434,31 @@ int main( int argc, char **argv)
 */
 TREE *BST_Create( void) {
     TREE *nTree = (TREE *) malloc (sizeof(TREE));
-    nTree->root = NULL;
+    if (!nTree) return NULL;
+    nTree->root = NIL;
+    nTree->blocks = NULL;
+    nTree->blockCount = 0;
+    nTree->blockCapacity = 0;
+    nTree->used = 1; // index 0 is NIL
+    nTree->freeList = NIL;
     return nTree;
 }
 
 /* Deletes all data in tree and recycles memory
+	frees the arena blocks, not the nodes one by one
 */
 void BST_Destroy( TREE *pTree) {
-    if (pTree->root) {
-        _destroy(pTree->root);
-    }
+    _destroy(pTree);
     free(pTree);
 }
 
 /* internal function (not mandatory)
 */
-static void _destroy( NODE *root) {
-    if (!root) return;
-    else {
-        _destroy(root->left);
-        _destroy(root->right);
-        free(root);
+static void _destroy( TREE *pTree) {
+    for (unsigned int i = 0; i < pTree->blockCount; i++) {
+        free(pTree->blocks[i]);
     }
+    free(pTree->blocks);
 }
 
 /* Inserts new data into the tree
@@ -241,46 +466,88 @@ static void _destroy( NODE *root) {
 			0 overflow
 */
 int BST_Insert( TREE *pTree, int data) {
-    NODE *newPtr = _makeNode(data);
-    if (!newPtr ) return 0;
+    unsigned int newIndex = _makeNode(pTree, data);
+    if (newIndex == NIL) return 0;
 
-    if (pTree->root == NULL) {
-        pTree->root = newPtr;
+    if (pTree->root == NIL) {
+        pTree->root = newIndex;
         return 1;
     }
     else {
-        _insert(pTree->root, newPtr);
+        _insert(pTree, pTree->root, newIndex);
         return 1;
     }
 }
 
 /* internal function (not mandatory)
 */
-static void _insert( NODE *root, NODE *newPtr) {
-    if (!root) return;
+static void _insert( TREE *pTree, unsigned int root, unsigned int newIndex) {
+    int data = _node(pTree, newIndex)->data;
+
+    // walk down iteratively: a sorted input makes the tree as deep as it is long
+    while (root != NIL) {
+        NODE *rootNode = _node(pTree, root);
+        unsigned int *link = (rootNode->data > data) ? &rootNode->left : &rootNode->right;
 
-    if (root->data > newPtr->data) {
-        if (root->left == NULL) {
-            root->left = newPtr;
+        if (*link == NIL) {
+            *link = newIndex;
             return;
         }
-        _insert(root->left, newPtr);
+        root = *link;
+    }
+}
+
+/* internal function
+	return	address of the node with the index
+*/
+static NODE *_node( TREE *pTree, unsigned int index) {
+    return &pTree->blocks[index / ARENA_BLOCK][index % ARENA_BLOCK];
+}
+
+/* internal function
+	Takes a node from the free list or the arena
+	return	index of the node
+			NIL if overflow
+*/
+static unsigned int _makeNode( TREE *pTree, int data) {
+    unsigned int index;
+    NODE *nNode;
+
+    if (pTree->freeList != NIL) {
+        index = pTree->freeList;
+        pTree->freeList = _node(pTree, index)->right;
     }
     else {
-        if (root->right == NULL) {
-            root->right = newPtr;
-            return;
+        if (pTree->used >= pTree->blockCount * ARENA_BLOCK) {
+            // indices of the new block must fit in 32 bits
+            if (pTree->blockCount == UINT_MAX / ARENA_BLOCK) return NIL;
+            if (pTree->blockCount == pTree->blockCapacity) {
+                // the table doubles, so it is copied O(log n) times
+                unsigned int capacity = pTree->blockCapacity ? pTree->blockCapacity * 2 : 16;
+                NODE **nBlocks = (NODE **) realloc (pTree->blocks, sizeof(NODE *) * capacity);
+                if (!nBlocks) return NIL;
+                pTree->blocks = nBlocks;
+                pTree->blockCapacity = capacity;
+            }
+            pTree->blocks[pTree->blockCount] = (NODE *) malloc (sizeof(NODE) * ARENA_BLOCK);
+            if (!pTree->blocks[pTree->blockCount]) return NIL;
+            pTree->blockCount++;
         }
-        _insert(root->right, newPtr);
+        index = pTree->used++;
     }
+    nNode = _node(pTree, index);
+    nNode->data = data;
+    nNode->left = NIL;
+    nNode->right = NIL;
+    return index;
 }
 
-NODE *_makeNode( int data) {
-    NODE *nNode = (NODE *) malloc (sizeof(NODE));
-    nNode->data = data;
-    nNode->left = NULL;
-    nNode->right = NULL;
-    return nNode;
+/* internal function
+	Returns a node to the free list
+*/
+static void _freeNode( TREE *pTree, unsigned int index) {
+    _node(pTree, index)->right = pTree->freeList;
+    pTree->freeList = index;
 }
 
 /* Deletes a node with dltKey from the tree
@@ -290,23 +557,25 @@ NODE *_makeNode( int data) {
 int BST_Delete( TREE *pTree, int dltKey) {
     int success;
 
-	if (pTree->root != NULL) {
-		if (pTree->root->data == dltKey && pTree->root->left == NULL) {
-			if (pTree->root->left == NULL) {
-				NODE *tmp = pTree->root->right;
-				free(pTree->root);
+	if (pTree->root != NIL) {
+		NODE *rootNode = _node(pTree, pTree->root);
+
+		if (rootNode->data == dltKey && rootNode->left == NIL) {
+			if (rootNode->left == NIL) {
+				unsigned int tmp = rootNode->right;
+				_freeNode(pTree, pTree->root);
 				pTree->root = tmp;
 				success = 1;
 			}
-			else if (pTree->root->right == NULL) {
-				NODE *tmp = pTree->root->left;
-				free(pTree->root);
+			else if (rootNode->right == NIL) {
+				unsigned int tmp = rootNode->left;
+				_freeNode(pTree, pTree->root);
 				pTree->root = tmp;
 				success = 1;
 			}
 		}
 		else {
-			pTree->root = _delete(pTree->root, dltKey, &success);
+			pTree->root = _delete(pTree, pTree->root, dltKey, &success);
 		}
 	}
 	else return 0;
@@ -318,45 +587,47 @@ int BST_Delete( TREE *pTree, int dltKey) {
 	success is 1 if deleted; 0 if not
 	return	pointer to root
 */
-static NODE *_delete( NODE *root, int dltKey, int *success) {
-    if (!root) {
+static unsigned int _delete( TREE *pTree, unsigned int root, int dltKey, int *success) {
+    if (root == NIL) {
 		*success = 0;
-		return NULL;
+		return NIL;
 		//fprintf(stderr, "root is null\n");
 	}
-	else if (root->data > dltKey) {
-		root->left = _delete(root->left, dltKey, success);
+	NODE *rootNode = _node(pTree, root);
+
+	if (rootNode->data > dltKey) {
+		rootNode->left = _delete(pTree, rootNode->left, dltKey, success);
 		//fprintf(stderr, "root data is bigger than key\n");
 	}
-	else if (root->data < dltKey) {
-		root->right = _delete(root->right, dltKey, success);
+	else if (rootNode->data < dltKey) {
+		rootNode->right = _delete(pTree, rootNode->right, dltKey, success);
 		
 		//fprintf(stderr, "root data is smaller than key\n");
 	}
-	else if (root->right == NULL) {
-		NODE *tmp = root->left;
-		free(root);
+	else if (rootNode->right == NIL) {
+		unsigned int tmp = rootNode->left;
+		_freeNode(pTree, root);
 		root = tmp;
 		*success = 1;
 		
 		//fprintf(stderr, "root right is null and delete success\n");
 	}
-	else if (root->left == NULL) {
-		NODE *tmp = root->right;
-		free(root);
+	else if (rootNode->left == NIL) {
+		unsigned int tmp = rootNode->right;
+		_freeNode(pTree, root);
 		root = tmp;
 		*success = 1;
 
 		//fprintf(stderr, "root left is null and delete success\n");
 	}
 	else {
-		NODE *tmp = root->right;
-		while (tmp->left != NULL) {
-			tmp = tmp->left;
+		NODE *tmp = _node(pTree, rootNode->right);
+		while (tmp->left != NIL) {
+			tmp = _node(pTree, tmp->left);
 		}
-		root->data = tmp->data;
+		rootNode->data = tmp->data;
 		//fprintf(stderr, "root and daughter change\n");
-		root->right = _delete(root->right, tmp->data, success);
+		rootNode->right = _delete(pTree, rootNode->right, tmp->data, success);
 	}
 	return root;
 }
@@ -366,11 +637,12 @@ static NODE *_delete( NODE *root, int dltKey, int *success) {
 			NULL not found
 */
 int *BST_Retrieve( TREE *pTree, int key) {
-    if (pTree->root) {
-		NODE *foundNode = _retrieve(pTree->root, key);
+    if (pTree->root != NIL) {
+		NODE *foundNode = _retrieve(pTree, pTree->root, key);
 		if (foundNode) return &(foundNode->data);
 		else return NULL;
 	}
+	return NULL;
 }
 
 /* internal function
@@ -378,59 +650,156 @@ int *BST_Retrieve( TREE *pTree, int key) {
 	return	address of the node containing the key
 			NULL not found
 */
-static NODE *_retrieve( NODE *root, int key) {
-    if (root) {
-		if ((root->data) > key) {
-			return _retrieve(root->left, key);
-		}
-		else if ((root->data) < key) {
-			return _retrieve(root->right, key);
-		}
-		else {
-			return root;
-		}
-	}
-	else {
-		return NULL;
+static NODE *_retrieve( TREE *pTree, unsigned int root, int key) {
+    while (root != NIL) {
+		NODE *rootNode = _node(pTree, root);
+
+		if ((rootNode->data) > key) root = rootNode->left;
+		else if ((rootNode->data) < key) root = rootNode->right;
+		else return rootNode;
 	}
+	return NULL;
 }
 
 /* prints tree using inorder traversal
 */
 void BST_Traverse( TREE *pTree) {
-    if (pTree->root) {
-        _traverse(pTree->root);
+    if (pTree->root != NIL) {
+        _traverse(pTree, pTree->root);
     }
 }
-static void _traverse( NODE *root) {
-    if (root) {
-		_traverse(root->left);
-		printf("%d ", root->data);
-		_traverse(root->right);
+static void _traverse( TREE *pTree, unsigned int root) {
+    if (root != NIL) {
+		NODE *rootNode = _node(pTree, root);
+
+		_traverse(pTree, rootNode->left);
+		printf("%d ", rootNode->data);
+		_traverse(pTree, rootNode->right);
+	}
+}
+
+/* Visits nodes whose data lies in [lo, hi] in ascending order
+	subtrees entirely outside the range are not visited
+*/
+void BST_RangeTraverse( TREE *pTree, int lo, int hi, void (*callback)(int data)) {
+	if (pTree->root != NIL && lo <= hi) {
+		_rangeTraverse(pTree, pTree->root, lo, hi, callback);
+	}
+}
+static void _rangeTraverse( TREE *pTree, unsigned int root, int lo, int hi, void (*callback)(int data)) {
+	if (root == NIL) return;
+	NODE *rootNode = _node(pTree, root);
+
+	// left subtree holds data < root->data
+	if (rootNode->data > lo) {
+		_rangeTraverse(pTree, rootNode->left, lo, hi, callback);
+	}
+	if (rootNode->data >= lo && rootNode->data <= hi) {
+		callback(rootNode->data);
+	}
+	// right subtree holds data >= root->data
+	if (rootNode->data <= hi) {
+		_rangeTraverse(pTree, rootNode->right, lo, hi, callback);
+	}
+}
+
+/* Deletes all nodes whose data lies in [lo, hi]
+	the tree is split around the range, the middle part is freed and the rest is joined again
+	return	number of deleted nodes
+*/
+int BST_DeleteRange( TREE *pTree, int lo, int hi) {
+	unsigned int mid, high = NIL;
+	unsigned int low;
+	int count;
+
+	if (pTree->root == NIL || lo > hi) return 0;
+
+	low = _split(pTree, pTree->root, lo, &mid);
+	if (hi < INT_MAX) {
+		mid = _split(pTree, mid, hi + 1, &high);
+	}
+	count = _deleteAll(pTree, mid);
+
+	// every node of low is smaller than every node of high
+	if (low == NIL) {
+		pTree->root = high;
+	}
+	else {
+		NODE *tmp = _node(pTree, low);
+		while (tmp->right != NIL) {
+			tmp = _node(pTree, tmp->right);
+		}
+		tmp->right = high;
+		pTree->root = low;
+	}
+	return count;
+}
+
+/* internal function
+	Splits the tree into nodes with data < key and nodes with data >= key
+	geRoot receives the root of the (data >= key) part
+	return	root of the (data < key) part
+*/
+static unsigned int _split( TREE *pTree, unsigned int root, int key, unsigned int *geRoot) {
+	if (root == NIL) {
+		*geRoot = NIL;
+		return NIL;
 	}
+	NODE *rootNode = _node(pTree, root);
+
+	if (rootNode->data < key) {
+		rootNode->right = _split(pTree, rootNode->right, key, geRoot);
+		return root;
+	}
+	else {
+		unsigned int lt = _split(pTree, rootNode->left, key, &rootNode->left);
+		*geRoot = root;
+		return lt;
+	}
+}
+
+/* internal function
+	Frees all nodes of the (sub)tree
+	return	number of freed nodes
+*/
+static int _deleteAll( TREE *pTree, unsigned int root) {
+	int count;
+
+	if (root == NIL) return 0;
+	count = _deleteAll(pTree, _node(pTree, root)->left) + _deleteAll(pTree, _node(pTree, root)->right) + 1;
+	_freeNode(pTree, root);
+	return count;
+}
+
+/* Prints data followed by a space
+	callback of BST_RangeTraverse
+*/
+static void printNumber( int data) {
+	printf("%d ", data);
 }
 
 /* Print tree using inorder right-to-left traversal
 */
 void printTree( TREE *pTree) {
-    if (pTree->root) {
-        _inorder_print(pTree->root, 0);
+    if (pTree->root != NIL) {
+        _inorder_print(pTree, pTree->root, 0);
     }
 }
 /* internal traversal function
 */
-static void _inorder_print( NODE *root, int level) {
-    if (!root) return;
+static void _inorder_print( TREE *pTree, unsigned int root, int level) {
+    if (root == NIL) return;
+    NODE *rootNode = _node(pTree, root);
 
-    if (root->right) {
-        _inorder_print(root->right, level+1);
+    if (rootNode->right != NIL) {
+        _inorder_print(pTree, rootNode->right, level+1);
     }
     for (int i=0; i<level; i++) {
         printf("\t");
     }
-    printf("%d\n", root->data);
-    if (root->left) {
-        _inorder_print(root->left, level+1);
+    printf("%d\n", rootNode->data);
+    if (rootNode->left != NIL) {
+        _inorder_print(pTree, rootNode->left, level+1);
     }
 }
 
@@ -438,6 +807,367 @@ static void _inorder_print( NODE *root, int level) {
 	return 1 if the tree is empty; 0 if not
 */
 int BST_Empty( TREE *pTree) {
-    if (pTree->root) return 0;
+    if (pTree->root != NIL) return 0;
     else return 1;
-}
\ No newline at end of file
+}
+
+/*
+	return	height of the tree (0 if empty)
+			-1 overflow
+*/
+int BST_Height( TREE *pTree) {
+	return _height(pTree, pTree->root);
+}
+static int _height( TREE *pTree, unsigned int root) {
+	// explicit stack of (node, depth) so that a degenerate tree cannot overflow the call stack
+	unsigned int *nodes;
+	int *depths;
+	int top = 0, capacity = 64, height = 0;
+
+	if (root == NIL) return 0;
+	nodes = (unsigned int *) malloc (sizeof(unsigned int) * capacity);
+	depths = (int *) malloc (sizeof(int) * capacity);
+	if (!nodes || !depths) {
+		free( nodes);
+		free( depths);
+		return -1;
+	}
+
+	nodes[top] = root;
+	depths[top++] = 1;
+	while (top > 0) {
+		unsigned int index = nodes[--top];
+		int depth = depths[top];
+		NODE *node = _node(pTree, index);
+
+		if (depth > height) height = depth;
+		if (top + 2 > capacity) {
+			unsigned int *newNodes = (unsigned int *) realloc (nodes, sizeof(unsigned int) * capacity * 2);
+			int *newDepths;
+
+			if (newNodes) nodes = newNodes;
+			newDepths = (int *) realloc (depths, sizeof(int) * capacity * 2);
+			if (newDepths) depths = newDepths;
+			if (!newNodes || !newDepths) {
+				height = -1;
+				break;
+			}
+			capacity *= 2;
+		}
+		if (node->left != NIL) {
+			nodes[top] = node->left;
+			depths[top++] = depth + 1;
+		}
+		if (node->right != NIL) {
+			nodes[top] = node->right;
+			depths[top++] = depth + 1;
+		}
+	}
+	free( nodes);
+	free( depths);
+	return height;
+}
+
+/*
+	return	bytes of memory held by the tree (head and arena blocks)
+*/
+size_t BST_Memory( TREE *pTree) {
+	return sizeof(TREE) + (size_t) pTree->blockCapacity * sizeof(NODE *) + (size_t) pTree->blockCount * sizeof(NODE) * ARENA_BLOCK;
+}
+
+/* Writes the tree to a binary snapshot file
+	header: magic (4 bytes), number of nodes (4 bytes, little endian)
+	then one varint per node in preorder: zigzag(data - previous data) << 2 | HAS_LEFT | HAS_RIGHT
+	return	1 success
+			0 file error
+*/
+int BST_Save( TREE *pTree, const char *filename) {
+	FILE *fp = fopen(filename, "wb");
+	unsigned char header[8] = SNAPSHOT_MAGIC;
+	unsigned int count;
+	int prev = 0;
+
+	if (!fp) return 0;
+
+	fwrite(header, 1, sizeof(header), fp);
+	count = _save(pTree, pTree->root, fp, &prev);
+
+	// node count is known only after the traversal
+	for (int i = 0; i < 4; i++) {
+		header[4 + i] = (count >> (8 * i)) & 0xFF;
+	}
+	fseek(fp, 0, SEEK_SET);
+	fwrite(header, 1, sizeof(header), fp);
+
+	if (ferror(fp)) {
+		fclose(fp);
+		return 0;
+	}
+	return (fclose(fp) == 0) ? 1 : 0;
+}
+
+/* internal function
+	Writes the preorder records of the (sub)tree
+	return	number of written nodes
+*/
+static unsigned int _save( TREE *pTree, unsigned int root, FILE *fp, int *prev) {
+	long long delta;
+	unsigned long long record;
+
+	if (root == NIL) return 0;
+	NODE *rootNode = _node(pTree, root);
+
+	delta = (long long) rootNode->data - *prev;
+	*prev = rootNode->data;
+	record = (delta < 0) ? ((unsigned long long) (-(delta + 1)) << 1) | 1 : (unsigned long long) delta << 1;
+	record = (record << 2) | (rootNode->left != NIL ? HAS_LEFT : 0) | (rootNode->right != NIL ? HAS_RIGHT : 0);
+	while (record >= 0x80) {
+		putc((int) (record & 0x7F) | 0x80, fp);
+		record >>= 7;
+	}
+	putc((int) record, fp);
+
+	return _save(pTree, rootNode->left, fp, prev) + _save(pTree, rootNode->right, fp, prev) + 1;
+}
+
+/* Rebuilds a tree from a snapshot file written by BST_Save
+	the file is mapped into memory and decoded without comparisons or rebalancing
+	return	tree head pointer
+			NULL if the file is not a valid snapshot or overflow
+*/
+TREE *BST_Load( const char *filename) {
+	int fd = open(filename, O_RDONLY);
+	struct stat st;
+	unsigned char *map;
+	unsigned int count = 0;
+	TREE *pTree;
+
+	if (fd < 0) return NULL;
+	if (fstat(fd, &st) < 0 || st.st_size < 8) {
+		close(fd);
+		return NULL;
+	}
+	map = (unsigned char *) mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) return NULL;
+
+	if (memcmp(map, SNAPSHOT_MAGIC, 4) != 0) {
+		munmap(map, st.st_size);
+		return NULL;
+	}
+	for (int i = 0; i < 4; i++) {
+		count |= (unsigned int) map[4 + i] << (8 * i);
+	}
+
+	pTree = BST_Create();
+	if (pTree && !_load(pTree, map + 8, map + st.st_size, count)) {
+		BST_Destroy(pTree);
+		pTree = NULL;
+	}
+	munmap(map, st.st_size);
+	return pTree;
+}
+
+/* internal function
+	Decodes the preorder records in [p, end) into pTree
+	return	1 success
+			0 malformed data or overflow
+*/
+static int _load( TREE *pTree, const unsigned char *p, const unsigned char *end, unsigned int count) {
+	unsigned int *stack = NULL; // nodes still waiting for their right child
+	int top = 0, size = 0;
+	unsigned int *slot = &pTree->root;
+	int prev = 0;
+	unsigned int i;
+
+	if (count == 0) return (p == end) ? 1 : 0;
+
+	for (i = 0; i < count; i++) {
+		unsigned long long record = 0;
+		int shift = 0;
+		long long delta;
+		unsigned int node;
+
+		if (slot == NULL) break; // more records than the tree shape allows
+		do {
+			if (p == end || shift > 63) {
+				free(stack);
+				return 0;
+			}
+			record |= (unsigned long long) (*p & 0x7F) << shift;
+			shift += 7;
+		} while (*p++ & 0x80);
+
+		delta = ((record >> 2) & 1) ? -(long long) (record >> 3) - 1 : (long long) (record >> 3);
+		node = _makeNode(pTree, (int) (prev + delta));
+		if (node == NIL) {
+			free(stack);
+			return 0;
+		}
+		prev = _node(pTree, node)->data;
+		*slot = node;
+
+		if (record & HAS_RIGHT) {
+			if (top == size) {
+				size = size ? size * 2 : 64;
+				unsigned int *tmp = (unsigned int *) realloc(stack, sizeof(unsigned int) * size);
+				if (!tmp) {
+					free(stack);
+					return 0;
+				}
+				stack = tmp;
+			}
+			stack[top++] = node;
+		}
+		// nodes never move, so a slot stays valid while more nodes are made
+		if (record & HAS_LEFT) slot = &_node(pTree, node)->left;
+		else if (top > 0) slot = &_node(pTree, stack[--top])->right;
+		else slot = NULL;
+	}
+	free(stack);
+
+	// every announced child must have been read
+	return (i == count && slot == NULL && p == end) ? 1 : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Benchmark mode
+
+static unsigned long long rngState = 0x9E3779B97F4A7C15ULL;
+
+/* xorshift64* pseudo random number generator
+	return	32 random bits
+*/
+static unsigned int _random( void) {
+	rngState ^= rngState >> 12;
+	rngState ^= rngState << 25;
+	rngState ^= rngState >> 27;
+	return (unsigned int) ((rngState * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+/* Fills keys with numbers (1 ~ n * 3) following the given distribution
+	return	1 success
+			0 overflow
+*/
+static int _makeKeys( int *keys, int n, int dist) {
+	int range = n * 3;
+
+	if (dist == DIST_UNIFORM) {
+		for (int i = 0; i < n; i++) {
+			keys[i] = _random() % range + 1;
+		}
+	}
+	else if (dist == DIST_SORTED || dist == DIST_REVERSE) {
+		for (int i = 0; i < n; i++) {
+			int key = i * 3 + _random() % 3 + 1;
+			if (dist == DIST_SORTED) keys[i] = key;
+			else keys[n - 1 - i] = key;
+		}
+	}
+	else if (dist == DIST_ZIPF) {
+		// rank r is drawn with probability 1/(r+1) / H(ranks)
+		// each rank owns a bucket of keys scattered over the range
+		int ranks = ZIPF_RANKS;
+		while (ranks > range) ranks /= 2;
+		int stride = range / ranks;
+		double *cdf = (double *) malloc (sizeof(double) * ranks);
+		double sum = 0.0;
+
+		if (!cdf) return 0;
+
+		for (int r = 0; r < ranks; r++) {
+			sum += 1.0 / (r + 1);
+			cdf[r] = sum;
+		}
+		for (int i = 0; i < n; i++) {
+			double u = _random() / 4294967296.0 * sum;
+			int lo = 0, hi = ranks - 1;
+			while (lo < hi) {
+				int mid = (lo + hi) / 2;
+				if (cdf[mid] < u) lo = mid + 1;
+				else hi = mid;
+			}
+			int bucket = (int) ((lo * 2654435761u) & (ranks - 1));
+			keys[i] = bucket * stride + _random() % stride + 1;
+		}
+		free(cdf);
+	}
+	else if (dist == DIST_CLUSTERED) {
+		int center = 0;
+		for (int i = 0; i < n; i++) {
+			if (i % CLUSTER_SIZE == 0) center = _random() % range + 1;
+			int key = center + (int) (_random() % CLUSTER_WIDTH) - CLUSTER_WIDTH / 2;
+			if (key < 1) key = 1;
+			if (key > range) key = range;
+			keys[i] = key;
+		}
+	}
+	return 1;
+}
+
+/* Inserts, looks up and deletes n keys without printing them
+	and reports throughput, tree height and memory
+	return	0 success
+			1 overflow
+*/
+static int benchmark( int dist, int n) {
+	const char *dists[] = {"uniform", "sorted", "reverse", "zipf", "clustered"};
+	int requested = n;
+	int *keys, *queries;
+	TREE *tree;
+	clock_t start;
+	double sec;
+	int found = 0;
+
+	if ((dist == DIST_SORTED || dist == DIST_REVERSE) && n > DEGENERATE_MAX) n = DEGENERATE_MAX;
+	keys = (int *) malloc (sizeof(int) * n);
+	queries = (int *) malloc (sizeof(int) * n);
+	tree = BST_Create();
+	if (!keys || !queries || !tree) {
+		fprintf( stderr, "Cannot allocate benchmark data!\n");
+		return 1;
+	}
+
+	rngState ^= (unsigned long long) time(NULL);
+	if (!_makeKeys( keys, n, dist) || !_makeKeys( queries, n, dist)) {
+		fprintf( stderr, "Cannot allocate benchmark data!\n");
+		return 1;
+	}
+
+	fprintf( stdout, "Distribution: %s, keys: %d\n", dists[dist], n);
+	if (n < requested)
+		fprintf( stdout, "(capped from %d: a %s insert order degenerates the tree into a list)\n", requested, dists[dist]);
+
+	start = clock();
+	for (int i = 0; i < n; i++) {
+		if (!BST_Insert( tree, keys[i])) {
+			fprintf( stderr, "Cannot insert into the tree!\n");
+			return 1;
+		}
+	}
+	sec = (double) (clock() - start) / CLOCKS_PER_SEC;
+	fprintf( stdout, "Insert: %.3f sec (%.0f ops/sec)\n", sec, n / (sec > 0 ? sec : 1e-9));
+
+	fprintf( stdout, "Height: %d\n", BST_Height( tree));
+	fprintf( stdout, "Memory: %zu bytes (%.1f bytes/key)\n", BST_Memory( tree), (double) BST_Memory( tree) / n);
+
+	start = clock();
+	for (int i = 0; i < n; i++) {
+		if (BST_Retrieve( tree, queries[i])) found++;
+	}
+	sec = (double) (clock() - start) / CLOCKS_PER_SEC;
+	fprintf( stdout, "Lookup: %.3f sec (%.0f ops/sec, %d found)\n", sec, n / (sec > 0 ? sec : 1e-9), found);
+
+	// keys are deleted in insertion order
+	start = clock();
+	for (int i = 0; i < n; i++) {
+		BST_Delete( tree, keys[i]);
+	}
+	sec = (double) (clock() - start) / CLOCKS_PER_SEC;
+	fprintf( stdout, "Delete: %.3f sec (%.0f ops/sec)\n", sec, n / (sec > 0 ? sec : 1e-9));
+
+	BST_Destroy( tree);
+	free(keys);
+	free(queries);
+	return 0;
+}
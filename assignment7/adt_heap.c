@@ -1,5 +1,6 @@
 #include <stdio.h>
-#include <stdlib.h> // malloc, realloc
+#include <stdlib.h> // malloc, aligned_alloc
+#include <string.h> // memcpy
 
 #include "adt_heap.h"
 
@@ -12,25 +13,112 @@ static void _reheapUp( HEAP *heap, int index);
 */
 static void _reheapDown( HEAP *heap, int index);
 
+/* Moves heap array to a new aligned block that holds capacity elements
+return 1 if successful; 0 if memory overflow
+*/
+static int _resize( HEAP *heap, int capacity);
+
+/* Arranges the whole heap array bottom-up (Floyd), O(n)
+*/
+static void _heapify( HEAP *heap);
+
+/* internal functions of the radix heap engine
+*/
+static int _radixIndex( unsigned int lastKey, unsigned int key);
+static int _radixPush( RADIX_BUCKET *bucket, unsigned int key, void *data);
+static int _radixInsert( HEAP *heap, void *dataPtr);
+
+/* Moves data of the first non-empty bucket down so that bucket 0 holds the smallest key
+return 1 if successful; 0 if memory overflow
+*/
+static int _radixSettle( RADIX *radix);
+static int _radixDelete( HEAP *heap, void **dataOutPtr);
+static void _radixDestroy( RADIX *radix);
+
+/* Stream cursor of heap_Merge, the data of its merge heap
+*/
+typedef struct
+{
+    void *head; // current data of the stream
+    int stream; // index of the stream
+    int (*compare) (void *arg1, void *arg2); // compare of the merged data
+} MERGE_CURSOR;
+
+/* compare function of the merge heap
+the cursor with the smallest head (the lower stream on ties) comes to the root
+*/
+static int _mergeCompare( void *arg1, void *arg2);
+
 /* Allocates memory for heap and returns address of heap head structure
+arity is the number of children per node (2, 4 or 8)
+if memory overflow or arity is not supported, NULL returned
+*/
+HEAP *heap_Create( int capacity, int arity, int (*compare) (void *arg1, void *arg2));
+
+/* Allocates memory for a heap that uses the radix heap engine
+key( data) gives the priority of data; the smallest key is deleted first,
+and a key may not be smaller than the key of the last deleted data (monotone)
 if memory overflow, NULL returned
 */
-HEAP *heap_Create( int capacity, int (*compare) (void *arg1, void *arg2));
+HEAP *heap_CreateRadix( unsigned int (*key) (void *data));
 
 /* Free memory for heap
 */
 void heap_Destroy( HEAP *heap);
 
 /* Inserts data into heap
-return 1 if successful; 0 if heap full
+return 1 if successful; 0 if memory overflow (or key smaller than the last deleted key in a radix heap)
 */
 int heap_Insert( HEAP *heap, void *dataPtr);
 
+/* Allocates a heap holding the n items and arranges them with bottom-up heapify in O(n)
+items array is copied, the data pointers are owned by the heap
+heap array starts at n but may shrink below it as data is deleted
+if memory overflow or arity is not supported, NULL returned
+*/
+HEAP *heap_BuildFrom( void **items, int n, int arity, int (*compare) (void *arg1, void *arg2));
+
+/* Inserts n items into heap
+a large batch is appended and the whole heap is heapified again,
+a small one is inserted item by item
+return 1 if successful; 0 if memory overflow
+*/
+int heap_InsertBatch( HEAP *heap, void **items, int n);
+
 /* Deletes index of heap and passes data back to caller
+heap array is halved when it becomes less than a quarter full (not below minCapacity)
 return 1 if successful; 0 if heap empty
 */
 int heap_Delete( HEAP *heap, void **dataOutPtr);
 
+/* Makes room for capacity data and keeps heap array at least that large
+return 1 if successful; 0 if memory overflow
+*/
+int heap_Reserve( HEAP *heap, int capacity);
+
+/* Shrinks heap array to the number of data in heap
+return 1 if successful; 0 if memory overflow
+*/
+int heap_ShrinkToFit( HEAP *heap);
+
+/* Passes root of heap back to caller without deleting it
+return 1 if successful; 0 if heap empty
+*/
+int heap_Peek( HEAP *heap, void **dataOutPtr);
+
+/* Replaces root of heap with dataPtr and passes the old root back to caller
+costs one reheap down instead of a delete and an insert
+return 1 if successful; 0 if heap empty
+(a radix heap also returns 0, unchanged, if the key of dataPtr is smaller than the key of the root
+or if memory overflows)
+*/
+int heap_Replace( HEAP *heap, void *dataPtr, void **dataOutPtr);
+
+/*
+return number of data in heap
+*/
+int heap_Count( HEAP *heap);
+
 /*
 return 1 if the heap is empty; 0 if not
 */
@@ -39,64 +127,136 @@ int heap_Empty(  HEAP *heap);
 /* Print heap array */
 void heap_Print( HEAP *heap, void (*print_func) (void *data));
 
+/* Sorts arr in ascending order of compare, in place, with a 4-ary heap
+*/
+void heap_Sort( void **arr, int n, int (*compare) (void *arg1, void *arg2));
+
+/* Merges k sorted streams through a heap of stream cursors
+next( cursor, dataOutPtr) passes the next data of a stream back and returns 1; returns 0 at end of stream
+emit( data) receives all data in ascending order of compare (equal data in stream order)
+return 1 if successful; 0 if memory overflow
+*/
+int heap_Merge( void **cursors, int k, int (*next) (void *cursor, void **dataOutPtr),
+    int (*compare) (void *arg1, void *arg2), void (*emit) (void *data));
+
 /////////////////////////////////////////////////////////////////
 /* Reestablishes heap by moving data in child up to correct location heap array
+moves a hole up instead of swapping, data is written once at its final position
 */
 static void _reheapUp( HEAP *heap, int index) {
+    void *hold = heap->heapArr[index];
     int parent;
-    void* hold;
-
-        if (index) {
-            parent = (index - 1)/ 2;
-            if (heap->compare(heap->heapArr[index], heap->heapArr[parent]) > 0) {
-                hold = heap->heapArr[parent];
-                heap->heapArr[parent] = heap->heapArr[index];
-                heap->heapArr[index] = hold;
-                _reheapUp (heap, parent);
-            }
-        }
+
+    while (index > 0) {
+        parent = (index - 1) / heap->arity;
+        if (heap->compare(hold, heap->heapArr[parent]) <= 0) break;
+        heap->heapArr[index] = heap->heapArr[parent];
+        index = parent;
+    }
+    heap->heapArr[index] = hold;
 }
 
 
 /* Reestablishes heap by moving data in index down to its correct location in the heap
+moves a hole down instead of swapping, data is written once at its final position
 */
 static void _reheapDown( HEAP *heap, int index) {
-    void* hold;
-    void* leftKey;
-    void* rightKey;
+    void *hold = heap->heapArr[index];
     int largeSubtree;
+    int child, lastChild;
 
-    if ((index * 2 + 1) <= heap->last) {
-        leftKey = heap->heapArr[index * 2 + 1];
-        if ((index * 2 + 2) <= heap->last) rightKey = heap->heapArr[index * 2 + 2];
-        else rightKey = NULL;
-
-        if ((!rightKey) || heap->compare(leftKey, rightKey) >= 0) {
-            largeSubtree = index * 2 + 1;
-        }
-        else {
-            largeSubtree = index * 2 + 2;
-        }
-        if (heap->compare(heap->heapArr[index], heap->heapArr[largeSubtree]) < 0) {
-            hold = heap->heapArr[index];
-            heap->heapArr[index] = heap->heapArr[largeSubtree];
-            heap->heapArr[largeSubtree] = hold;
-            _reheapDown (heap, largeSubtree);
+    while ((largeSubtree = index * heap->arity + 1) <= heap->last) {
+        lastChild = largeSubtree + heap->arity - 1;
+        if (lastChild > heap->last) lastChild = heap->last;
+        for (child = largeSubtree + 1; child <= lastChild; child++) {
+            if (heap->compare(heap->heapArr[largeSubtree], heap->heapArr[child]) < 0) {
+                largeSubtree = child;
+            }
         }
+        if (heap->compare(hold, heap->heapArr[largeSubtree]) >= 0) break;
+        heap->heapArr[index] = heap->heapArr[largeSubtree];
+        index = largeSubtree;
     }
+    heap->heapArr[index] = hold;
+}
+
+/* Moves heap array to a new aligned block that holds capacity elements
+return 1 if successful; 0 if memory overflow
+*/
+static int _resize( HEAP *heap, int capacity) {
+    // heapArr starts (arity - 1) slots into the block,
+    // so the children of every node begin on a cache line boundary
+    size_t bytes = sizeof(void*) * ((size_t) capacity + heap->arity - 1);
+    bytes = (bytes + HEAP_CACHE_LINE - 1) / HEAP_CACHE_LINE * HEAP_CACHE_LINE;
+
+    void **newBase = (void **) aligned_alloc(HEAP_CACHE_LINE, bytes);
+    if (!newBase) return 0;
+
+    if (heap->heapBase) {
+        memcpy(newBase + heap->arity - 1, heap->heapArr, sizeof(void*) * (heap->last + 1));
+        free(heap->heapBase);
+        if (capacity > heap->capacity) heap->growCount++;
+        else heap->shrinkCount++;
+    }
+    heap->heapBase = newBase;
+    heap->heapArr = newBase + heap->arity - 1;
+    heap->capacity = capacity;
+    return 1;
 }
 
 /* Allocates memory for heap and returns address of heap head structure
-if memory overflow, NULL returned
+arity is the number of children per node (2, 4 or 8)
+if memory overflow or arity is not supported, NULL returned
 */
-HEAP *heap_Create( int capacity, int (*compare) (void *arg1, void *arg2)) {
+HEAP *heap_Create( int capacity, int arity, int (*compare) (void *arg1, void *arg2)) {
+    if (arity != 2 && arity != 4 && arity != 8) return NULL;
+    if (capacity < 1) capacity = 1;
+
     HEAP *newHeap = (HEAP *) malloc (sizeof(HEAP));
-    
+    if (!newHeap) return NULL;
+
     newHeap->last = -1;
-    newHeap->capacity = capacity;
+    newHeap->arity = arity;
     newHeap->compare = compare;
+    newHeap->heapBase = NULL;
+    newHeap->minCapacity = capacity;
+    newHeap->growCount = 0;
+    newHeap->shrinkCount = 0;
+    newHeap->radix = NULL;
+
+    if (!_resize(newHeap, capacity)) {
+        free(newHeap);
+        return NULL;
+    }
+    return newHeap;
+}
+
+/* Allocates memory for a heap that uses the radix heap engine
+key( data) gives the priority of data; the smallest key is deleted first,
+and a key may not be smaller than the key of the last deleted data (monotone)
+if memory overflow, NULL returned
+*/
+HEAP *heap_CreateRadix( unsigned int (*key) (void *data)) {
+    HEAP *newHeap = (HEAP *) malloc (sizeof(HEAP));
+    if (!newHeap) return NULL;
 
-    newHeap->heapArr = (void **) malloc(sizeof(void*) * capacity);
+    newHeap->radix = (RADIX *) calloc (1, sizeof(RADIX));
+    if (!newHeap->radix) {
+        free(newHeap);
+        return NULL;
+    }
+    newHeap->radix->key = key;
+
+    // the comparison heap fields are not used by the radix engine
+    newHeap->heapArr = NULL;
+    newHeap->heapBase = NULL;
+    newHeap->last = -1;
+    newHeap->capacity = 0;
+    newHeap->arity = 0;
+    newHeap->minCapacity = 0;
+    newHeap->growCount = 0;
+    newHeap->shrinkCount = 0;
+    newHeap->compare = NULL;
     return newHeap;
 }
 
@@ -104,51 +264,209 @@ HEAP *heap_Create( int capacity, int (*compare) (void *arg1, void *arg2)) {
 */
 void heap_Destroy( HEAP *heap) {
     void *cur;
+
+    if (heap->radix) {
+        _radixDestroy(heap->radix);
+        free(heap);
+        return;
+    }
     while (!heap_Empty(heap)) {
         cur = heap->heapArr[heap->last];
         heap->last--;
         free(cur);
     }
-    free(heap->heapArr);
+    free(heap->heapBase);
     free(heap);
 }
 
 /* Inserts data into heap
-return 1 if successful; 0 if heap full
+return 1 if successful; 0 if memory overflow
 */
 int heap_Insert( HEAP *heap, void *dataPtr) {
+    if (heap->radix) return _radixInsert(heap, dataPtr);
+
     if (heap_Empty(heap)) {
         heap->last = 0;
         heap->heapArr[heap->last] = dataPtr;
     }
     else {
         if (heap->capacity == heap->last + 1) {
-            heap->capacity *= 2;
-            heap->heapArr = (void**) realloc(heap->heapArr, heap->capacity * sizeof(void*));
-            heap->last++;
-            heap->heapArr[heap->last] = dataPtr;
+            if (!_resize(heap, heap->capacity * 2)) return 0;
+        }
+        heap->last++;
+        heap->heapArr[heap->last] = dataPtr;
+        _reheapUp(heap, heap->last);
+    }
+    return 1;
+}
+
+/* Arranges the whole heap array bottom-up (Floyd), O(n)
+*/
+static void _heapify( HEAP *heap) {
+    if (heap->last < 1) return;
+    for (int index = (heap->last - 1) / heap->arity; index >= 0; index--) {
+        _reheapDown(heap, index);
+    }
+}
+
+/* Allocates a heap holding the n items and arranges them with bottom-up heapify in O(n)
+items array is copied, the data pointers are owned by the heap
+heap array starts at n but may shrink below it as data is deleted
+if memory overflow or arity is not supported, NULL returned
+*/
+HEAP *heap_BuildFrom( void **items, int n, int arity, int (*compare) (void *arg1, void *arg2)) {
+    HEAP *newHeap = heap_Create(n, arity, compare);
+    if (!newHeap) return NULL;
+    newHeap->minCapacity = 1; // only an explicit capacity or heap_Reserve raises the floor
+
+    memcpy(newHeap->heapArr, items, sizeof(void*) * n);
+    newHeap->last = n - 1;
+    _heapify(newHeap);
+    return newHeap;
+}
+
+/* Inserts n items into heap
+a large batch is appended and the whole heap is heapified again,
+a small one is inserted item by item
+return 1 if successful; 0 if memory overflow
+*/
+int heap_InsertBatch( HEAP *heap, void **items, int n) {
+    int size = heap->last + 1 + n;
+    int capacity = heap->capacity;
+    int depth = 0;
+
+    if (n <= 0) return 1;
+
+    if (heap->radix) {
+        for (int i = 0; i < n; i++) {
+            if (!_radixInsert(heap, items[i])) return 0;
         }
-        else {
+        return 1;
+    }
+
+    while (capacity < size) capacity *= 2;
+    if (capacity != heap->capacity && !_resize(heap, capacity)) return 0;
+
+    // heapify costs about 2 * size compares, item by item insertion up to n * depth
+    for (int nodes = 1; nodes < size; nodes = nodes * heap->arity + 1) depth++;
+
+    if ((long long) n * depth > 2LL * size) {
+        memcpy(heap->heapArr + heap->last + 1, items, sizeof(void*) * n);
+        heap->last += n;
+        _heapify(heap);
+    }
+    else {
+        for (int i = 0; i < n; i++) {
             heap->last++;
-            heap->heapArr[heap->last] = dataPtr;
+            heap->heapArr[heap->last] = items[i];
+            _reheapUp(heap, heap->last);
         }
-        _reheapUp(heap, heap->last);
     }
     return 1;
 }
 
 /* Deletes index of heap and passes data back to caller
+heap array is halved when it becomes less than a quarter full (not below minCapacity)
 return 1 if successful; 0 if heap empty
 */
 int heap_Delete( HEAP *heap, void **dataOutPtr) {
     if (heap_Empty(heap)) return 0;
+    if (heap->radix) return _radixDelete(heap, dataOutPtr);
+
     *dataOutPtr = heap->heapArr[0];
     heap->heapArr[0] = heap->heapArr[heap->last];
     heap->last--;
     _reheapDown(heap, 0);
+
+    // shrinking at 1/4 and growing at full leave a gap,
+    // so a heap size going up and down around one point does not reallocate every time
+    if (heap->last + 1 < heap->capacity / 4 && heap->capacity / 2 >= heap->minCapacity) {
+        _resize(heap, heap->capacity / 2); // on failure the larger array is kept
+    }
+    return 1;
+}
+
+/* Makes room for capacity data and keeps heap array at least that large
+return 1 if successful; 0 if memory overflow
+*/
+int heap_Reserve( HEAP *heap, int capacity) {
+    if (heap->radix) return 1; // buckets grow on their own
+    if (capacity > heap->capacity && !_resize(heap, capacity)) return 0;
+    if (capacity > heap->minCapacity) heap->minCapacity = capacity;
+    return 1;
+}
+
+/* Shrinks heap array to the number of data in heap
+return 1 if successful; 0 if memory overflow
+*/
+int heap_ShrinkToFit( HEAP *heap) {
+    int capacity = (heap->last + 1 > 0) ? heap->last + 1 : 1;
+
+    if (heap->radix) return 1; // buckets grow on their own
+    if (capacity == heap->capacity) return 1;
+    if (!_resize(heap, capacity)) return 0;
+    if (heap->minCapacity > capacity) heap->minCapacity = capacity;
+    return 1;
+}
+
+/* Passes root of heap back to caller without deleting it
+return 1 if successful; 0 if heap empty
+*/
+int heap_Peek( HEAP *heap, void **dataOutPtr) {
+    if (heap_Empty(heap)) return 0;
+    if (heap->radix) {
+        // finds the smallest key without moving data, so lastKey stays the last deleted key
+        RADIX_BUCKET *bucket = heap->radix->buckets;
+        int min = 0;
+
+        while (bucket->count == 0) bucket++;
+        if (bucket == heap->radix->buckets) min = bucket->count - 1;
+        for (int j = 0; j < bucket->count; j++) {
+            if (bucket->items[j].key < bucket->items[min].key) min = j;
+        }
+        *dataOutPtr = bucket->items[min].data;
+        return 1;
+    }
+    *dataOutPtr = heap->heapArr[0];
+    return 1;
+}
+
+/* Replaces root of heap with dataPtr and passes the old root back to caller
+costs one reheap down instead of a delete and an insert
+return 1 if successful; 0 if heap empty
+(a radix heap also returns 0, unchanged, if the key of dataPtr is smaller than the key of the root
+or if memory overflows)
+*/
+int heap_Replace( HEAP *heap, void *dataPtr, void **dataOutPtr) {
+    if (heap_Empty(heap)) return 0;
+    if (heap->radix) {
+        void *root;
+
+        // a key below the smallest one cannot enter after the root leaves, so nothing is moved
+        heap_Peek(heap, &root);
+        if (heap->radix->key(dataPtr) < heap->radix->key(root)) return 0;
+        if (!_radixDelete(heap, dataOutPtr)) return 0;
+        if (!_radixInsert(heap, dataPtr)) {
+            // the old root goes back to the bucket 0 slot it just left, which needs no memory
+            _radixPush(&heap->radix->buckets[0], heap->radix->lastKey, *dataOutPtr);
+            heap->last++;
+            return 0;
+        }
+        return 1;
+    }
+    *dataOutPtr = heap->heapArr[0];
+    heap->heapArr[0] = dataPtr;
+    _reheapDown(heap, 0);
     return 1;
 }
 
+/*
+return number of data in heap
+*/
+int heap_Count( HEAP *heap) {
+    return heap->last + 1;
+}
+
 /*
 return 1 if the heap is empty; 0 if not
 */
@@ -158,8 +476,200 @@ int heap_Empty(  HEAP *heap) {
 
 /* Print heap array */
 void heap_Print( HEAP *heap, void (*print_func) (void *data)) {
+    if (heap->radix) {
+        for (int i = 0; i < RADIX_BUCKETS; i++) {
+            for (int j = 0; j < heap->radix->buckets[i].count; j++) {
+                print_func(heap->radix->buckets[i].items[j].data);
+            }
+        }
+        printf("\n");
+        return;
+    }
     for (int i=0; i<=heap->last; i++) {
        print_func(heap->heapArr[i]);
     }
     printf("\n");
-}
\ No newline at end of file
+}
+
+/* Sorts arr in ascending order of compare, in place, with a 4-ary heap
+*/
+void heap_Sort( void **arr, int n, int (*compare) (void *arg1, void *arg2)) {
+    HEAP heap;
+    void *hold;
+
+    // arr is used as the heap array directly
+    heap.heapArr = arr;
+    heap.heapBase = NULL;
+    heap.last = n - 1;
+    heap.capacity = n;
+    heap.arity = 4;
+    heap.compare = compare;
+    heap.radix = NULL;
+
+    _heapify(&heap);
+    while (heap.last > 0) {
+        hold = arr[0];
+        arr[0] = arr[heap.last];
+        arr[heap.last] = hold;
+        heap.last--;
+        _reheapDown(&heap, 0);
+    }
+}
+
+/* compare function of the merge heap
+the cursor with the smallest head (the lower stream on ties) comes to the root
+*/
+static int _mergeCompare( void *arg1, void *arg2) {
+    MERGE_CURSOR *c1 = (MERGE_CURSOR *) arg1;
+    MERGE_CURSOR *c2 = (MERGE_CURSOR *) arg2;
+    int cmp = c1->compare(c2->head, c1->head);
+
+    if (cmp != 0) return cmp;
+    return (c1->stream < c2->stream) - (c1->stream > c2->stream);
+}
+
+/* Merges k sorted streams through a heap of stream cursors
+next( cursor, dataOutPtr) passes the next data of a stream back and returns 1; returns 0 at end of stream
+emit( data) receives all data in ascending order of compare (equal data in stream order)
+return 1 if successful; 0 if memory overflow
+*/
+int heap_Merge( void **cursors, int k, int (*next) (void *cursor, void **dataOutPtr),
+    int (*compare) (void *arg1, void *arg2), void (*emit) (void *data)) {
+    MERGE_CURSOR *records = (MERGE_CURSOR *) malloc(sizeof(MERGE_CURSOR) * (k > 0 ? k : 1));
+    void **items = (void **) malloc(sizeof(void*) * (k > 0 ? k : 1));
+    MERGE_CURSOR *cursor;
+    HEAP *heap = NULL;
+    int count = 0;
+
+    if (records && items) {
+        for (int i = 0; i < k; i++) {
+            if (!next(cursors[i], &records[i].head)) continue;
+            records[i].stream = i;
+            records[i].compare = compare;
+            items[count++] = &records[i];
+        }
+        heap = heap_BuildFrom(items, count, 4, _mergeCompare);
+    }
+    free(items);
+    if (!heap) {
+        free(records);
+        return 0;
+    }
+
+    // the root cursor is advanced in place and moved down with one reheap
+    while (heap_Peek(heap, (void **) &cursor)) {
+        emit(cursor->head);
+        if (next(cursors[cursor->stream], &cursor->head)) heap_Replace(heap, cursor, (void **) &cursor);
+        else heap_Delete(heap, (void **) &cursor);
+    }
+
+    // cursors are owned by records, not by the heap
+    heap_Destroy(heap);
+    free(records);
+    return 1;
+}
+
+/* internal function
+return bucket of key: 0 if key equals lastKey, otherwise 1 + highest bit where they differ
+*/
+static int _radixIndex( unsigned int lastKey, unsigned int key) {
+    unsigned int diff = key ^ lastKey;
+
+#if defined(__GNUC__)
+    return diff ? (int) (sizeof(unsigned int) * 8) - __builtin_clz(diff) : 0;
+#else
+    int index = 0;
+
+    while (diff) {
+        index++;
+        diff >>= 1;
+    }
+    return index;
+#endif
+}
+
+/* internal function
+Appends key and data to bucket
+return 1 if successful; 0 if memory overflow
+*/
+static int _radixPush( RADIX_BUCKET *bucket, unsigned int key, void *data) {
+    if (bucket->count == bucket->capacity) {
+        int capacity = bucket->capacity ? bucket->capacity * 2 : 16;
+        RADIX_ITEM *items = (RADIX_ITEM *) realloc(bucket->items, sizeof(RADIX_ITEM) * capacity);
+        if (!items) return 0;
+        bucket->items = items;
+        bucket->capacity = capacity;
+    }
+    bucket->items[bucket->count].key = key;
+    bucket->items[bucket->count].data = data;
+    bucket->count++;
+    return 1;
+}
+
+/* internal function
+Inserts data into the bucket of its key
+return 1 if successful; 0 if memory overflow or key is smaller than the last deleted key
+*/
+static int _radixInsert( HEAP *heap, void *dataPtr) {
+    RADIX *radix = heap->radix;
+    unsigned int key = radix->key(dataPtr);
+
+    if (key < radix->lastKey) return 0;
+    if (!_radixPush(&radix->buckets[_radixIndex(radix->lastKey, key)], key, dataPtr)) return 0;
+    heap->last++;
+    return 1;
+}
+
+/* Moves data of the first non-empty bucket down so that bucket 0 holds the smallest key
+return 1 if successful; 0 if memory overflow
+*/
+static int _radixSettle( RADIX *radix) {
+    RADIX_BUCKET *bucket;
+    unsigned int minKey;
+    int i = 0;
+
+    if (radix->buckets[0].count > 0) return 1;
+
+    while (radix->buckets[i].count == 0) i++;
+    bucket = &radix->buckets[i];
+
+    minKey = bucket->items[0].key;
+    for (int j = 1; j < bucket->count; j++) {
+        if (bucket->items[j].key < minKey) minKey = bucket->items[j].key;
+    }
+    radix->lastKey = minKey;
+
+    // every data of bucket i goes to a lower bucket relative to the new lastKey
+    while (bucket->count > 0) {
+        RADIX_ITEM *item = &bucket->items[bucket->count - 1];
+        if (!_radixPush(&radix->buckets[_radixIndex(minKey, item->key)], item->key, item->data)) return 0;
+        bucket->count--;
+    }
+    return 1;
+}
+
+/* internal function
+Deletes data with the smallest key
+return 1 if successful; 0 if memory overflow
+*/
+static int _radixDelete( HEAP *heap, void **dataOutPtr) {
+    RADIX_BUCKET *bucket = &heap->radix->buckets[0];
+
+    if (!_radixSettle(heap->radix)) return 0;
+    *dataOutPtr = bucket->items[--bucket->count].data;
+    heap->last--;
+    return 1;
+}
+
+/* internal function
+Frees buckets and the data left in them
+*/
+static void _radixDestroy( RADIX *radix) {
+    for (int i = 0; i < RADIX_BUCKETS; i++) {
+        for (int j = 0; j < radix->buckets[i].count; j++) {
+            free(radix->buckets[i].items[j].data);
+        }
+        free(radix->buckets[i].items);
+    }
+    free(radix);
+}
@@ -1,30 +1,119 @@
+#ifndef ADT_HEAP_H
+#define ADT_HEAP_H
+
+#define HEAP_CACHE_LINE	64 // children of a node are placed in one cache line
+#define RADIX_BUCKETS	33 // bucket 0 and one bucket per bit of an unsigned int key
+
+typedef struct
+{
+	unsigned int	key;
+	void			*data;
+} RADIX_ITEM;
+
+typedef struct
+{
+	RADIX_ITEM	*items;
+	int			count;
+	int			capacity;
+} RADIX_BUCKET;
+
+/* Radix heap engine for monotone unsigned int keys
+bucket i > 0 holds data whose key differs from lastKey first in bit i - 1,
+bucket 0 holds data whose key equals lastKey
+*/
+typedef struct
+{
+	RADIX_BUCKET	buckets[RADIX_BUCKETS];
+	unsigned int	lastKey; // key of the last deleted data
+	unsigned int	(*key) (void *data);
+} RADIX;
+
 typedef struct
 {
 	void **heapArr;
+	void **heapBase; // aligned allocation that holds heapArr
 	int	last;
 	int	capacity;
+	int	arity; // number of children per node (2, 4 or 8)
+	int	minCapacity; // heap_Delete does not shrink below this capacity
+	int	growCount; // number of reallocations that grew heap array
+	int	shrinkCount; // number of reallocations that shrank heap array
 	int (*compare) (void *arg1, void *arg2);
+	RADIX *radix; // radix heap engine, NULL for a comparison heap
 } HEAP;
 
 /* Allocates memory for heap and returns address of heap head structure
+arity is the number of children per node (2, 4 or 8)
+if memory overflow or arity is not supported, NULL returned
+*/
+HEAP *heap_Create( int capacity, int arity, int (*compare) (void *arg1, void *arg2));
+
+/* Allocates memory for a heap that uses the radix heap engine
+key( data) gives the priority of data; the smallest key is deleted first,
+and a key may not be smaller than the key of the last deleted data (monotone)
+heap_Insert, heap_Delete, heap_Peek, heap_Replace, heap_Empty, heap_Count,
+heap_Print and heap_Destroy work on it as on any heap
 if memory overflow, NULL returned
 */
-HEAP *heap_Create( int capacity, int (*compare) (void *arg1, void *arg2));
+HEAP *heap_CreateRadix( unsigned int (*key) (void *data));
 
 /* Free memory for heap
 */
 void heap_Destroy( HEAP *heap);
 
 /* Inserts data into heap
-return 1 if successful; 0 if heap full
+return 1 if successful; 0 if memory overflow (or key smaller than the last deleted key in a radix heap)
 */
 int heap_Insert( HEAP *heap, void *dataPtr);
 
+/* Allocates a heap holding the n items and arranges them with bottom-up heapify in O(n)
+items array is copied, the data pointers are owned by the heap
+heap array starts at n but may shrink below it as data is deleted
+if memory overflow or arity is not supported, NULL returned
+*/
+HEAP *heap_BuildFrom( void **items, int n, int arity, int (*compare) (void *arg1, void *arg2));
+
+/* Inserts n items into heap
+a large batch is appended and the whole heap is heapified again,
+a small one is inserted item by item
+return 1 if successful; 0 if memory overflow
+*/
+int heap_InsertBatch( HEAP *heap, void **items, int n);
+
 /* Deletes root of heap and passes data back to caller
+heap array is halved when it becomes less than a quarter full (not below minCapacity)
 return 1 if successful; 0 if heap empty
 */
 int heap_Delete( HEAP *heap, void **dataOutPtr);
 
+/* Makes room for capacity data and keeps heap array at least that large
+return 1 if successful; 0 if memory overflow
+*/
+int heap_Reserve( HEAP *heap, int capacity);
+
+/* Shrinks heap array to the number of data in heap
+return 1 if successful; 0 if memory overflow
+*/
+int heap_ShrinkToFit( HEAP *heap);
+
+/* Passes root of heap back to caller without deleting it
+return 1 if successful; 0 if heap empty
+*/
+int heap_Peek( HEAP *heap, void **dataOutPtr);
+
+/* Replaces root of heap with dataPtr and passes the old root back to caller
+costs one reheap down instead of a delete and an insert
+return 1 if successful; 0 if heap empty
+(a radix heap also returns 0, unchanged, if the key of dataPtr is smaller than the key of the root
+or if memory overflows)
+*/
+int heap_Replace( HEAP *heap, void *dataPtr, void **dataOutPtr);
+
+/*
+return number of data in heap
+*/
+int heap_Count( HEAP *heap);
+
 /*
 return 1 if the heap is empty; 0 if not
 */
@@ -33,3 +122,16 @@ int heap_Empty(  HEAP *heap);
 /* Print heap array */
 void heap_Print( HEAP *heap, void (*print_func) (void *data));
 
+/* Sorts arr in ascending order of compare, in place, with a 4-ary heap
+*/
+void heap_Sort( void **arr, int n, int (*compare) (void *arg1, void *arg2));
+
+/* Merges k sorted streams through a heap of stream cursors
+next( cursor, dataOutPtr) passes the next data of a stream back and returns 1; returns 0 at end of stream
+emit( data) receives all data in ascending order of compare (equal data in stream order)
+return 1 if successful; 0 if memory overflow
+*/
+int heap_Merge( void **cursors, int k, int (*next) (void *cursor, void **dataOutPtr),
+    int (*compare) (void *arg1, void *arg2), void (*emit) (void *data));
+
+#endif
@@ -0,0 +1,264 @@
+#include <stdio.h>
+#include <stdlib.h> // malloc, realloc
+
+#include "adt_iheap.h"
+
+/* Moves data at index up to its correct location, keeping posArr up to date
+*/
+static void _reheapUp( IHEAP *heap, int index);
+
+/* Moves data at index down to its correct location, keeping posArr up to date
+*/
+static void _reheapDown( IHEAP *heap, int index);
+
+/* Doubles the capacity of all arrays
+return 1 if successful; 0 if memory overflow
+*/
+static int _grow( IHEAP *heap);
+
+/* Takes the handle at index out of the heap and frees the handle
+*/
+static void _removeAt( IHEAP *heap, int index);
+
+/* Allocates memory for heap and returns address of heap head structure
+if memory overflow, NULL returned
+*/
+IHEAP *iheap_Create( int capacity, int (*compare) (void *arg1, void *arg2));
+
+/* Free memory for heap and the data left in it
+*/
+void iheap_Destroy( IHEAP *heap);
+
+/* Inserts data into heap
+return handle of the data (>= 0) if successful; -1 if memory overflow
+*/
+int iheap_Insert( IHEAP *heap, void *dataPtr);
+
+/* Deletes root of heap and passes data back to caller
+return 1 if successful; 0 if heap empty
+*/
+int iheap_Delete( IHEAP *heap, void **dataOutPtr);
+
+/* Passes root of heap back to caller without deleting it
+return 1 if successful; 0 if heap empty
+*/
+int iheap_Peek( IHEAP *heap, void **dataOutPtr);
+
+/* Replaces data of the handle and moves it to its new position
+dataPtr may be the same data whose key was changed by the caller;
+the previous data is not freed
+return 1 if successful; 0 if handle is not in the heap
+*/
+int iheap_Update( IHEAP *heap, int handle, void *dataPtr);
+
+/* Deletes data of the handle and passes it back to caller
+return 1 if successful; 0 if handle is not in the heap
+*/
+int iheap_Remove( IHEAP *heap, int handle, void **dataOutPtr);
+
+/*
+return 1 if the heap is empty; 0 if not
+*/
+int iheap_Empty( IHEAP *heap);
+
+/////////////////////////////////////////////////////////////////
+/* Moves data at index up to its correct location, keeping posArr up to date
+*/
+static void _reheapUp( IHEAP *heap, int index) {
+    int hold = heap->heapArr[index];
+    int parent;
+
+    while (index > 0) {
+        parent = (index - 1) / 2;
+        if (heap->compare(heap->dataArr[hold], heap->dataArr[heap->heapArr[parent]]) <= 0) break;
+        heap->heapArr[index] = heap->heapArr[parent];
+        heap->posArr[heap->heapArr[index]] = index;
+        index = parent;
+    }
+    heap->heapArr[index] = hold;
+    heap->posArr[hold] = index;
+}
+
+/* Moves data at index down to its correct location, keeping posArr up to date
+*/
+static void _reheapDown( IHEAP *heap, int index) {
+    int hold = heap->heapArr[index];
+    int largeSubtree;
+
+    while ((largeSubtree = index * 2 + 1) <= heap->last) {
+        if (largeSubtree + 1 <= heap->last
+            && heap->compare(heap->dataArr[heap->heapArr[largeSubtree]], heap->dataArr[heap->heapArr[largeSubtree + 1]]) < 0) {
+            largeSubtree++;
+        }
+        if (heap->compare(heap->dataArr[hold], heap->dataArr[heap->heapArr[largeSubtree]]) >= 0) break;
+        heap->heapArr[index] = heap->heapArr[largeSubtree];
+        heap->posArr[heap->heapArr[index]] = index;
+        index = largeSubtree;
+    }
+    heap->heapArr[index] = hold;
+    heap->posArr[hold] = index;
+}
+
+/* Doubles the capacity of all arrays
+return 1 if successful; 0 if memory overflow
+*/
+static int _grow( IHEAP *heap) {
+    int capacity = heap->capacity * 2;
+    int *heapArr = (int *) realloc(heap->heapArr, sizeof(int) * capacity);
+    if (heapArr) heap->heapArr = heapArr;
+    void **dataArr = (void **) realloc(heap->dataArr, sizeof(void*) * capacity);
+    if (dataArr) heap->dataArr = dataArr;
+    int *posArr = (int *) realloc(heap->posArr, sizeof(int) * capacity);
+    if (posArr) heap->posArr = posArr;
+    int *freeArr = (int *) realloc(heap->freeArr, sizeof(int) * capacity);
+    if (freeArr) heap->freeArr = freeArr;
+
+    // arrays that did grow keep working with the old capacity
+    if (!heapArr || !dataArr || !posArr || !freeArr) return 0;
+
+    heap->capacity = capacity;
+    return 1;
+}
+
+/* Takes the handle at index out of the heap and frees the handle
+*/
+static void _removeAt( IHEAP *heap, int index) {
+    int handle = heap->heapArr[index];
+    int moved = heap->heapArr[heap->last];
+
+    heap->posArr[handle] = -1;
+    heap->freeArr[heap->freeCount++] = handle;
+    heap->last--;
+
+    if (index <= heap->last) {
+        heap->heapArr[index] = moved;
+        heap->posArr[moved] = index;
+        // the last data may belong above or below the removed one
+        if (index > 0 && heap->compare(heap->dataArr[moved], heap->dataArr[heap->heapArr[(index - 1) / 2]]) > 0) {
+            _reheapUp(heap, index);
+        }
+        else {
+            _reheapDown(heap, index);
+        }
+    }
+}
+
+/* Allocates memory for heap and returns address of heap head structure
+if memory overflow, NULL returned
+*/
+IHEAP *iheap_Create( int capacity, int (*compare) (void *arg1, void *arg2)) {
+    IHEAP *newHeap = (IHEAP *) malloc (sizeof(IHEAP));
+    if (!newHeap) return NULL;
+    if (capacity < 1) capacity = 1;
+
+    newHeap->heapArr = (int *) malloc(sizeof(int) * capacity);
+    newHeap->dataArr = (void **) malloc(sizeof(void*) * capacity);
+    newHeap->posArr = (int *) malloc(sizeof(int) * capacity);
+    newHeap->freeArr = (int *) malloc(sizeof(int) * capacity);
+    if (!newHeap->heapArr || !newHeap->dataArr || !newHeap->posArr || !newHeap->freeArr) {
+        free(newHeap->heapArr);
+        free(newHeap->dataArr);
+        free(newHeap->posArr);
+        free(newHeap->freeArr);
+        free(newHeap);
+        return NULL;
+    }
+    newHeap->freeCount = 0;
+    newHeap->last = -1;
+    newHeap->capacity = capacity;
+    newHeap->compare = compare;
+    return newHeap;
+}
+
+/* Free memory for heap and the data left in it
+*/
+void iheap_Destroy( IHEAP *heap) {
+    for (int i = 0; i <= heap->last; i++) {
+        free(heap->dataArr[heap->heapArr[i]]);
+    }
+    free(heap->heapArr);
+    free(heap->dataArr);
+    free(heap->posArr);
+    free(heap->freeArr);
+    free(heap);
+}
+
+/* Inserts data into heap
+return handle of the data (>= 0) if successful; -1 if memory overflow
+*/
+int iheap_Insert( IHEAP *heap, void *dataPtr) {
+    int handle;
+
+    if (heap->freeCount > 0) {
+        handle = heap->freeArr[--heap->freeCount];
+    }
+    else {
+        // no free handle means handles 0 ~ last are all in use
+        if (heap->capacity == heap->last + 1 && !_grow(heap)) return -1;
+        handle = heap->last + 1;
+    }
+
+    heap->last++;
+    heap->heapArr[heap->last] = handle;
+    heap->dataArr[handle] = dataPtr;
+    _reheapUp(heap, heap->last);
+    return handle;
+}
+
+/* Deletes root of heap and passes data back to caller
+return 1 if successful; 0 if heap empty
+*/
+int iheap_Delete( IHEAP *heap, void **dataOutPtr) {
+    if (iheap_Empty(heap)) return 0;
+    *dataOutPtr = heap->dataArr[heap->heapArr[0]];
+    _removeAt(heap, 0);
+    return 1;
+}
+
+/* Passes root of heap back to caller without deleting it
+return 1 if successful; 0 if heap empty
+*/
+int iheap_Peek( IHEAP *heap, void **dataOutPtr) {
+    if (iheap_Empty(heap)) return 0;
+    *dataOutPtr = heap->dataArr[heap->heapArr[0]];
+    return 1;
+}
+
+/* Replaces data of the handle and moves it to its new position
+dataPtr may be the same data whose key was changed by the caller;
+the previous data is not freed
+return 1 if successful; 0 if handle is not in the heap
+*/
+int iheap_Update( IHEAP *heap, int handle, void *dataPtr) {
+    int index;
+
+    if (handle < 0 || handle > heap->last + heap->freeCount || heap->posArr[handle] < 0) return 0;
+
+    index = heap->posArr[handle];
+    heap->dataArr[handle] = dataPtr;
+    if (index > 0 && heap->compare(dataPtr, heap->dataArr[heap->heapArr[(index - 1) / 2]]) > 0) {
+        _reheapUp(heap, index);
+    }
+    else {
+        _reheapDown(heap, index);
+    }
+    return 1;
+}
+
+/* Deletes data of the handle and passes it back to caller
+return 1 if successful; 0 if handle is not in the heap
+*/
+int iheap_Remove( IHEAP *heap, int handle, void **dataOutPtr) {
+    if (handle < 0 || handle > heap->last + heap->freeCount || heap->posArr[handle] < 0) return 0;
+
+    *dataOutPtr = heap->dataArr[handle];
+    _removeAt(heap, heap->posArr[handle]);
+    return 1;
+}
+
+/*
+return 1 if the heap is empty; 0 if not
+*/
+int iheap_Empty( IHEAP *heap) {
+    return (heap->last == -1) ? 1: 0;
+}
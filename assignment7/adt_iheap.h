@@ -0,0 +1,61 @@
+#ifndef ADT_IHEAP_H
+#define ADT_IHEAP_H
+
+/* Indexed heap
+every inserted data gets a handle that stays valid until the data leaves the heap,
+so data can be updated or removed from the middle of the heap
+*/
+typedef struct
+{
+	int	*heapArr; // handles in heap order
+	void **dataArr; // data of each handle
+	int	*posArr; // position of each handle in heapArr, -1 if handle is free
+	int	*freeArr; // stack of free handles
+	int	freeCount;
+	int	last;
+	int	capacity;
+	int (*compare) (void *arg1, void *arg2);
+} IHEAP;
+
+/* Allocates memory for heap and returns address of heap head structure
+if memory overflow, NULL returned
+*/
+IHEAP *iheap_Create( int capacity, int (*compare) (void *arg1, void *arg2));
+
+/* Free memory for heap and the data left in it
+*/
+void iheap_Destroy( IHEAP *heap);
+
+/* Inserts data into heap
+return handle of the data (>= 0) if successful; -1 if memory overflow
+*/
+int iheap_Insert( IHEAP *heap, void *dataPtr);
+
+/* Deletes root of heap and passes data back to caller
+return 1 if successful; 0 if heap empty
+*/
+int iheap_Delete( IHEAP *heap, void **dataOutPtr);
+
+/* Passes root of heap back to caller without deleting it
+return 1 if successful; 0 if heap empty
+*/
+int iheap_Peek( IHEAP *heap, void **dataOutPtr);
+
+/* Replaces data of the handle and moves it to its new position
+dataPtr may be the same data whose key was changed by the caller;
+the previous data is not freed
+return 1 if successful; 0 if handle is not in the heap
+*/
+int iheap_Update( IHEAP *heap, int handle, void *dataPtr);
+
+/* Deletes data of the handle and passes it back to caller
+return 1 if successful; 0 if handle is not in the heap
+*/
+int iheap_Remove( IHEAP *heap, int handle, void **dataOutPtr);
+
+/*
+return 1 if the heap is empty; 0 if not
+*/
+int iheap_Empty( IHEAP *heap);
+
+#endif
@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h> // malloc, aligned_alloc
+
+#include "adt_mqueue.h"
+
+#define MQ_TRIES	8 // random tries of delete before all heaps are checked in turn
+
+/* xorshift32 pseudo random number generator, one state per thread
+return	random number
+*/
+static unsigned int _random( void);
+
+/* Allocates memory for a queue of count heaps and returns address of queue head structure
+if memory overflow, NULL returned
+*/
+MQUEUE *mqueue_Create( int count, int capacity, int (*compare) (void *arg1, void *arg2));
+
+/* Free memory for queue and the data left in it
+*/
+void mqueue_Destroy( MQUEUE *queue);
+
+/* Inserts data into a random heap of the queue (thread safe)
+return 1 if successful; 0 if memory overflow
+*/
+int mqueue_Insert( MQUEUE *queue, void *dataPtr);
+
+/* Deletes the larger root of two random heaps and passes data back to caller (thread safe)
+return 1 if successful; 0 if every heap was empty when it was checked
+*/
+int mqueue_Delete( MQUEUE *queue, void **dataOutPtr);
+
+/////////////////////////////////////////////////////////////////
+static _Thread_local unsigned int rngState;
+
+/* xorshift32 pseudo random number generator, one state per thread
+return	random number
+*/
+static unsigned int _random( void) {
+    if (rngState == 0) {
+        // seeds every thread differently from the address of its state
+        rngState = (unsigned int) (size_t) &rngState | 1;
+    }
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+/* Allocates memory for a queue of count heaps and returns address of queue head structure
+if memory overflow, NULL returned
+*/
+MQUEUE *mqueue_Create( int count, int capacity, int (*compare) (void *arg1, void *arg2)) {
+    if (count < 1) return NULL;
+
+    MQUEUE *newQueue = (MQUEUE *) malloc (sizeof(MQUEUE));
+    if (!newQueue) return NULL;
+
+    newQueue->lanes = (MQ_LANE *) aligned_alloc(HEAP_CACHE_LINE, sizeof(MQ_LANE) * count);
+    if (!newQueue->lanes) {
+        free(newQueue);
+        return NULL;
+    }
+    newQueue->count = count;
+    newQueue->compare = compare;
+
+    for (int i = 0; i < count; i++) {
+        pthread_mutex_init(&newQueue->lanes[i].lock, NULL);
+        newQueue->lanes[i].heap = heap_Create(capacity, 4, compare);
+        if (!newQueue->lanes[i].heap) {
+            pthread_mutex_destroy(&newQueue->lanes[i].lock); // lanes before i are released below
+            newQueue->count = i;
+            mqueue_Destroy(newQueue);
+            return NULL;
+        }
+    }
+    return newQueue;
+}
+
+/* Free memory for queue and the data left in it
+*/
+void mqueue_Destroy( MQUEUE *queue) {
+    for (int i = 0; i < queue->count; i++) {
+        heap_Destroy(queue->lanes[i].heap);
+        pthread_mutex_destroy(&queue->lanes[i].lock);
+    }
+    free(queue->lanes);
+    free(queue);
+}
+
+/* Inserts data into a random heap of the queue (thread safe)
+return 1 if successful; 0 if memory overflow
+*/
+int mqueue_Insert( MQUEUE *queue, void *dataPtr) {
+    MQ_LANE *lane;
+    int ret;
+
+    // a busy heap is skipped instead of waited for
+    do {
+        lane = &queue->lanes[_random() % queue->count];
+    } while (pthread_mutex_trylock(&lane->lock) != 0);
+
+    ret = heap_Insert(lane->heap, dataPtr);
+    pthread_mutex_unlock(&lane->lock);
+    return ret;
+}
+
+/* Deletes the larger root of two random heaps and passes data back to caller (thread safe)
+return 1 if successful; 0 if every heap was empty when it was checked
+*/
+int mqueue_Delete( MQUEUE *queue, void **dataOutPtr) {
+    void *root1, *root2;
+
+    for (int tries = 0; tries < MQ_TRIES; tries++) {
+        MQ_LANE *lane1 = &queue->lanes[_random() % queue->count];
+        MQ_LANE *lane2 = &queue->lanes[_random() % queue->count];
+
+        if (pthread_mutex_trylock(&lane1->lock) != 0) continue;
+        if (lane2 == lane1 || pthread_mutex_trylock(&lane2->lock) != 0) {
+            // only one heap could be taken; use it alone
+            lane2 = NULL;
+        }
+
+        // roots are compared while both heaps are locked,
+        // so neither root can be deleted and freed by another thread meanwhile
+        int has1 = heap_Peek(lane1->heap, &root1);
+        int has2 = lane2 ? heap_Peek(lane2->heap, &root2) : 0;
+        MQ_LANE *best = NULL;
+
+        if (has1 && (!has2 || queue->compare(root1, root2) >= 0)) best = lane1;
+        else if (has2) best = lane2;
+
+        if (best) heap_Delete(best->heap, dataOutPtr);
+
+        if (lane2) pthread_mutex_unlock(&lane2->lock);
+        pthread_mutex_unlock(&lane1->lock);
+        if (best) return 1;
+    }
+
+    // random heaps kept being empty or busy; checks every heap before giving up
+    for (int i = 0; i < queue->count; i++) {
+        MQ_LANE *lane = &queue->lanes[i];
+        int ret;
+
+        pthread_mutex_lock(&lane->lock);
+        ret = heap_Delete(lane->heap, dataOutPtr);
+        pthread_mutex_unlock(&lane->lock);
+        if (ret) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include <pthread.h>
+
+#include "adt_heap.h"
+
+/* Concurrent priority queue (MultiQueue)
+data is spread over several HEAPs, each behind its own lock.
+insert puts data into a random heap;
+delete locks two random heaps and deletes the larger of their roots.
+
+Ordering is relaxed: mqueue_Delete returns the larger root of two random heaps,
+not always the largest data in the queue. With h heaps the returned data is
+on average among the top O(h) data; use about 2 heaps per thread.
+*/
+typedef struct
+{
+	_Alignas(HEAP_CACHE_LINE) pthread_mutex_t lock; // one cache line per heap
+	HEAP	*heap;
+} MQ_LANE;
+
+typedef struct
+{
+	MQ_LANE	*lanes;
+	int	count; // number of heaps
+	int (*compare) (void *arg1, void *arg2);
+} MQUEUE;
+
+/* Allocates memory for a queue of count heaps and returns address of queue head structure
+if memory overflow, NULL returned
+*/
+MQUEUE *mqueue_Create( int count, int capacity, int (*compare) (void *arg1, void *arg2));
+
+/* Free memory for queue and the data left in it
+must not be called while other threads use the queue
+*/
+void mqueue_Destroy( MQUEUE *queue);
+
+/* Inserts data into a random heap of the queue (thread safe)
+return 1 if successful; 0 if memory overflow
+*/
+int mqueue_Insert( MQUEUE *queue, void *dataPtr);
+
+/* Deletes the larger root of two random heaps and passes data back to caller (thread safe)
+return 1 if successful; 0 if every heap was empty when it was checked
+*/
+int mqueue_Delete( MQUEUE *queue, void **dataOutPtr);
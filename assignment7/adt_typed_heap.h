@@ -0,0 +1,124 @@
+#ifndef ADT_TYPED_HEAP_H
+#define ADT_TYPED_HEAP_H
+
+#include <stdlib.h> // malloc, realloc
+#include <string.h> // memcmp
+
+/* Heaps that store keys inline in the heap array
+instead of void * data and a compare function pointer.
+TYPED_HEAP generates the head structure and the functions for one key type;
+GREATER(a, b) is nonzero if a belongs closer to the root (max heap like HEAP)
+
+	HEAP_NAME	name of the head structure type
+	PREFIX		prefix of the function names (PREFIX##_Create, PREFIX##_Insert, ...)
+	TYPE		key type stored in the heap array
+*/
+#define TYPED_HEAP( HEAP_NAME, PREFIX, TYPE, GREATER) \
+ \
+typedef struct \
+{ \
+	TYPE *heapArr; \
+	int	last; \
+	int	capacity; \
+} HEAP_NAME; \
+ \
+/* Allocates memory for heap and returns address of heap head structure \
+if memory overflow, NULL returned \
+*/ \
+static inline HEAP_NAME *PREFIX##_Create( int capacity) { \
+    HEAP_NAME *heap = (HEAP_NAME *) malloc (sizeof(HEAP_NAME)); \
+    if (!heap) return NULL; \
+    if (capacity < 1) capacity = 1; \
+    heap->heapArr = (TYPE *) malloc (sizeof(TYPE) * capacity); \
+    if (!heap->heapArr) { \
+        free(heap); \
+        return NULL; \
+    } \
+    heap->last = -1; \
+    heap->capacity = capacity; \
+    return heap; \
+} \
+ \
+/* Free memory for heap \
+*/ \
+static inline void PREFIX##_Destroy( HEAP_NAME *heap) { \
+    free(heap->heapArr); \
+    free(heap); \
+} \
+ \
+/* \
+return 1 if the heap is empty; 0 if not \
+*/ \
+static inline int PREFIX##_Empty( HEAP_NAME *heap) { \
+    return (heap->last == -1) ? 1 : 0; \
+} \
+ \
+/* Inserts data into heap, moving a hole up from the last position \
+return 1 if successful; 0 if memory overflow \
+*/ \
+static inline int PREFIX##_Insert( HEAP_NAME *heap, TYPE data) { \
+    int index, parent; \
+ \
+    if (heap->capacity == heap->last + 1) { \
+        TYPE *newArr = (TYPE *) realloc(heap->heapArr, sizeof(TYPE) * heap->capacity * 2); \
+        if (!newArr) return 0; \
+        heap->heapArr = newArr; \
+        heap->capacity *= 2; \
+    } \
+    index = ++heap->last; \
+    while (index > 0) { \
+        parent = (index - 1) / 2; \
+        if (!(GREATER(data, heap->heapArr[parent]))) break; \
+        heap->heapArr[index] = heap->heapArr[parent]; \
+        index = parent; \
+    } \
+    heap->heapArr[index] = data; \
+    return 1; \
+} \
+ \
+/* Deletes root of heap and passes data back to caller, moving a hole down from the root \
+return 1 if successful; 0 if heap empty \
+*/ \
+static inline int PREFIX##_Delete( HEAP_NAME *heap, TYPE *dataOutPtr) { \
+    TYPE hold; \
+    int index = 0, child; \
+ \
+    if (heap->last == -1) return 0; \
+    *dataOutPtr = heap->heapArr[0]; \
+    hold = heap->heapArr[heap->last--]; \
+    while ((child = index * 2 + 1) <= heap->last) { \
+        if (child + 1 <= heap->last && GREATER(heap->heapArr[child + 1], heap->heapArr[child])) child++; \
+        if (!(GREATER(heap->heapArr[child], hold))) break; \
+        heap->heapArr[index] = heap->heapArr[child]; \
+        index = child; \
+    } \
+    if (heap->last >= 0) heap->heapArr[index] = hold; \
+    return 1; \
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Specializations
+
+#define HEAP_STR_LEN	16 // bytes of a fixed length string key (zero padded)
+
+typedef struct
+{
+	long long	key;
+	void		*payload;
+} HEAP_PAIR;
+
+typedef struct
+{
+	char	key[HEAP_STR_LEN];
+} HEAP_STR;
+
+#define HEAP_GREATER( a, b)		((a) > (b))
+#define HEAP_PAIR_GREATER( a, b)	((a).key > (b).key)
+#define HEAP_STR_GREATER( a, b)	(memcmp((a).key, (b).key, HEAP_STR_LEN) > 0)
+
+TYPED_HEAP( INT_HEAP, intheap, int, HEAP_GREATER)
+TYPED_HEAP( INT64_HEAP, int64heap, long long, HEAP_GREATER)
+TYPED_HEAP( PAIR_HEAP, pairheap, HEAP_PAIR, HEAP_PAIR_GREATER)
+TYPED_HEAP( STR_HEAP, strheap, HEAP_STR, HEAP_STR_GREATER)
+
+#endif
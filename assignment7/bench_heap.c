@@ -0,0 +1,352 @@
+#include <stdio.h>
+#include <stdlib.h> // malloc, atoi
+#include <time.h> // clock
+
+#include "adt_heap.h"
+#include "adt_typed_heap.h"
+
+#define MIN_ELEM	1000 // smallest heap size of the default sweep
+#define MAX_ELEM	1000000 // largest heap size of the default sweep
+#define BURST_CYCLES	3 // fill and drain cycles of the burst workload
+
+/* user-defined compare function */
+int compare(void *arg1, void *arg2)
+{
+	int *a1 = (int *)arg1;
+	int *a2 = (int *)arg2;
+
+	return (*a1 > *a2) - (*a1 < *a2);
+}
+
+/* compare function of the monotone workload: the smallest number comes to the root */
+int compare_min(void *arg1, void *arg2)
+{
+	return compare(arg2, arg1);
+}
+
+/* key function of the radix heap */
+unsigned int key(void *data)
+{
+	return (unsigned int)*(int *)data;
+}
+
+/* xorshift32 pseudo random number generator */
+static unsigned int rngState = 2463534242u;
+
+static unsigned int next_random(void)
+{
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 17;
+	rngState ^= rngState << 5;
+	return rngState;
+}
+
+static double elapsed(clock_t start)
+{
+	double sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+	return (sec > 0) ? sec : 1e-9;
+}
+
+/* Runs the workloads on a heap of the given arity and prints ns/op
+	build:    builds the heap from all numbers at once with heap_BuildFrom
+	delete:   deletes until the heap is empty
+	insert:   inserts every number (run_int_heap workload)
+	pop+push: deletes the root and inserts a new number, heap size stays the same
+return 0 if successful; 1 if heap order is violated or memory overflow
+*/
+static int run(int *data, int numbers, int arity)
+{
+	HEAP *heap;
+	int *dataPtr;
+	clock_t start;
+	double buildSec, deleteSec, insertSec, updateSec;
+	void **items = (void **)malloc( sizeof(void *) * numbers);
+
+	if (!items) return 1;
+	for (int i = 0; i < numbers; i++)
+	{
+		items[i] = &data[i];
+	}
+
+	start = clock();
+	heap = heap_BuildFrom( items, numbers, arity, compare);
+	if (!heap) return 1;
+	buildSec = elapsed( start);
+	free(items);
+
+	start = clock();
+	int prev = numbers * 3 + 1;
+	while (!heap_Empty( heap))
+	{
+		heap_Delete( heap, (void **)&dataPtr);
+		if (*dataPtr > prev)
+		{
+			fprintf( stderr, "Heap order violated!\n");
+			return 1;
+		}
+		prev = *dataPtr;
+	}
+	deleteSec = elapsed( start);
+
+	start = clock();
+	for (int i = 0; i < numbers; i++)
+	{
+		if (!heap_Insert( heap, &data[i])) return 1;
+	}
+	insertSec = elapsed( start);
+
+	start = clock();
+	for (int i = 0; i < numbers; i++)
+	{
+		heap_Delete( heap, (void **)&dataPtr);
+		heap_Insert( heap, &data[numbers + i]);
+	}
+	updateSec = elapsed( start);
+
+	fprintf( stdout, "%10d %5d %10.1f %10.1f %10.1f %10.1f\n", numbers, arity, buildSec * 1e9 / numbers,
+		insertSec * 1e9 / numbers, updateSec * 1e9 / numbers, deleteSec * 1e9 / numbers);
+
+	// data is owned by the benchmark, not by the heap
+	while (!heap_Empty( heap))
+	{
+		heap_Delete( heap, (void **)&dataPtr);
+	}
+	heap_Destroy( heap);
+	return 0;
+}
+
+/* Runs the same workloads on INT_HEAP (keys inline, compare inlined)
+return 0 if successful; 1 if heap order is violated or memory overflow
+*/
+static int run_typed(int *data, int numbers)
+{
+	INT_HEAP *heap;
+	int key;
+	clock_t start;
+	double deleteSec, insertSec, updateSec;
+
+	heap = intheap_Create( numbers);
+	if (!heap) return 1;
+	for (int i = 0; i < numbers; i++)
+	{
+		intheap_Insert( heap, data[i]);
+	}
+
+	start = clock();
+	int prev = numbers * 3 + 1;
+	while (!intheap_Empty( heap))
+	{
+		intheap_Delete( heap, &key);
+		if (key > prev)
+		{
+			fprintf( stderr, "Heap order violated!\n");
+			return 1;
+		}
+		prev = key;
+	}
+	deleteSec = elapsed( start);
+
+	start = clock();
+	for (int i = 0; i < numbers; i++)
+	{
+		if (!intheap_Insert( heap, data[i])) return 1;
+	}
+	insertSec = elapsed( start);
+
+	start = clock();
+	for (int i = 0; i < numbers; i++)
+	{
+		intheap_Delete( heap, &key);
+		intheap_Insert( heap, data[numbers + i]);
+	}
+	updateSec = elapsed( start);
+
+	fprintf( stdout, "%10d %5s %10s %10.1f %10.1f %10.1f\n", numbers, "int", "-",
+		insertSec * 1e9 / numbers, updateSec * 1e9 / numbers, deleteSec * 1e9 / numbers);
+
+	intheap_Destroy( heap);
+	return 0;
+}
+
+/* Dijkstra-like workload with monotone keys: deletes the smallest number k
+and inserts k + 1 ~ k + 1000, heap size stays the same
+arity 0 runs the radix heap engine
+return 0 if successful; 1 if heap order is violated or memory overflow
+*/
+static int run_monotone(int *data, int numbers, int arity)
+{
+	HEAP *heap;
+	int *dataPtr;
+	clock_t start;
+	double sec;
+
+	heap = arity ? heap_Create( 10, arity, compare_min) : heap_CreateRadix( key);
+	if (!heap) return 1;
+
+	for (int i = 0; i < numbers; i++)
+	{
+		data[i] = next_random() % 1000;
+		if (!heap_Insert( heap, &data[i])) return 1;
+	}
+
+	start = clock();
+	int prev = 0;
+	for (int i = 0; i < numbers; i++)
+	{
+		heap_Delete( heap, (void **)&dataPtr);
+		if (*dataPtr < prev)
+		{
+			fprintf( stderr, "Heap order violated!\n");
+			return 1;
+		}
+		prev = *dataPtr;
+		*dataPtr += next_random() % 1000 + 1;
+		if (!heap_Insert( heap, dataPtr)) return 1;
+	}
+	sec = elapsed( start);
+
+	fprintf( stdout, "%10d %5s %10.1f\n", numbers, arity == 0 ? "radix" : arity == 2 ? "2" : arity == 4 ? "4" : "8",
+		sec * 1e9 / numbers);
+
+	// data is owned by the benchmark, not by the heap
+	while (!heap_Empty( heap))
+	{
+		heap_Delete( heap, (void **)&dataPtr);
+	}
+	heap_Destroy( heap);
+	return 0;
+}
+
+/* Burst workload: fills the heap with every number and drains it BURST_CYCLES times,
+then fills the array exactly and moves the heap size up and down by one across it
+prints reallocations (growCount, shrinkCount) and capacities of each phase
+return 0 if successful; 1 if heap order is violated or memory overflow
+*/
+static int run_burst(int *data, int numbers)
+{
+	HEAP *heap;
+	int *dataPtr;
+	int grows = 0, shrinks = 0;
+
+	heap = heap_Create( 10, 4, compare);
+	if (!heap) return 1;
+
+	for (int cycle = 1; cycle <= BURST_CYCLES; cycle++)
+	{
+		int peak;
+
+		for (int i = 0; i < numbers; i++)
+		{
+			if (!heap_Insert( heap, &data[i])) return 1;
+		}
+		peak = heap->capacity;
+		int prev = numbers * 3 + 1;
+		while (!heap_Empty( heap))
+		{
+			heap_Delete( heap, (void **)&dataPtr);
+			if (*dataPtr > prev)
+			{
+				fprintf( stderr, "Heap order violated!\n");
+				return 1;
+			}
+			prev = *dataPtr;
+		}
+		fprintf( stdout, "%10d %9d %10d %10d %10d %10d\n", numbers, cycle, heap->growCount - grows,
+			heap->shrinkCount - shrinks, peak, heap->capacity);
+		grows = heap->growCount;
+		shrinks = heap->shrinkCount;
+	}
+
+	// hysteresis: a size that moves up and down across a full array reallocates only once
+	int count = 0;
+	while (count < numbers / 2 || heap_Count( heap) < heap->capacity)
+	{
+		if (!heap_Insert( heap, &data[count++ % numbers])) return 1;
+	}
+	grows = heap->growCount;
+	shrinks = heap->shrinkCount;
+	for (int i = 0; i < numbers; i++)
+	{
+		if (!heap_Insert( heap, &data[i])) return 1;
+		heap_Delete( heap, (void **)&dataPtr);
+	}
+	fprintf( stdout, "%10d %9s %10d %10d %10d %10s\n", numbers, "+1/-1", heap->growCount - grows,
+		heap->shrinkCount - shrinks, heap->capacity, "-");
+
+	while (!heap_Empty( heap))
+	{
+		heap_Delete( heap, (void **)&dataPtr);
+	}
+	heap_Destroy( heap);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int *data;
+	int minElem = MIN_ELEM, maxElem = MAX_ELEM;
+
+	if (argc == 2) minElem = maxElem = atoi(argv[1]);
+	if (argc > 2 || minElem <= 0)
+	{
+		fprintf( stderr, "usage: %s [number]\n", argv[0]);
+		return 1;
+	}
+
+	// keys are allocated up front so that malloc is not measured
+	data = (int *)malloc( sizeof(int) * maxElem * 2);
+	if (!data)
+	{
+		fprintf( stderr, "Cannot allocate %d numbers!\n", maxElem);
+		return 1;
+	}
+
+	fprintf( stdout, "%10s %5s %10s %10s %10s %10s (ns/op)\n", "number", "arity", "build", "insert", "pop+push", "delete");
+	for (int numbers = minElem; numbers <= maxElem; numbers *= 10)
+	{
+		for (int i = 0; i < numbers * 2; i++)
+		{
+			data[i] = next_random() % (numbers * 3u) + 1;
+		}
+		for (int arity = 2; arity <= 8; arity *= 2)
+		{
+			if (run( data, numbers, arity))
+			{
+				fprintf( stderr, "Benchmark failed!\n");
+				return 1;
+			}
+		}
+		if (run_typed( data, numbers))
+		{
+			fprintf( stderr, "Benchmark failed!\n");
+			return 1;
+		}
+	}
+
+	fprintf( stdout, "\n%10s %5s %10s (ns/op, monotone keys)\n", "number", "heap", "pop+push");
+	for (int numbers = minElem; numbers <= maxElem; numbers *= 10)
+	{
+		for (int arity = 0; arity <= 4; arity += 2)
+		{
+			if (run_monotone( data, numbers, arity))
+			{
+				fprintf( stderr, "Benchmark failed!\n");
+				return 1;
+			}
+		}
+	}
+
+	fprintf( stdout, "\n%10s %9s %10s %10s %10s %10s (4-ary, initial capacity 10)\n", "number", "cycle", "grows",
+		"shrinks", "peak", "drained");
+	for (int numbers = minElem; numbers <= maxElem; numbers *= 10)
+	{
+		if (run_burst( data, numbers))
+		{
+			fprintf( stderr, "Benchmark failed!\n");
+			return 1;
+		}
+	}
+	free(data);
+
+	return 0;
+}
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h> // malloc, atoi
+#include <time.h> // clock_gettime
+#include <unistd.h> // sysconf
+#include <pthread.h>
+
+#include "adt_heap.h"
+#include "adt_mqueue.h"
+
+#define PREFILL		1000000 // number of data in the queue during the benchmark
+#define OPS			1000000 // pop+push pairs per thread
+#define LANES		2 // heaps per thread in MQUEUE
+
+/* user-defined compare function */
+int compare(void *arg1, void *arg2)
+{
+	int *a1 = (int *)arg1;
+	int *a2 = (int *)arg2;
+
+	return (*a1 > *a2) - (*a1 < *a2);
+}
+
+/* xorshift32 pseudo random number generator, one state per thread */
+static unsigned int next_random(unsigned int *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// baseline: one HEAP behind one global mutex
+static HEAP *globalHeap;
+static pthread_mutex_t globalLock = PTHREAD_MUTEX_INITIALIZER;
+
+static MQUEUE *queue;
+
+typedef struct
+{
+	unsigned int	seed;
+	int				ops;
+	int				useQueue; // 1: MQUEUE, 0: global HEAP
+} WORKER;
+
+/* deletes a data, gives it a new key and inserts it again */
+static void *worker(void *arg)
+{
+	WORKER *w = (WORKER *)arg;
+	int *dataPtr;
+
+	for (int i = 0; i < w->ops; i++)
+	{
+		if (w->useQueue)
+		{
+			if (!mqueue_Delete( queue, (void **)&dataPtr)) continue;
+			*dataPtr = next_random( &w->seed) % (PREFILL * 3) + 1;
+			mqueue_Insert( queue, dataPtr);
+		}
+		else
+		{
+			pthread_mutex_lock( &globalLock);
+			heap_Delete( globalHeap, (void **)&dataPtr);
+			*dataPtr = next_random( &w->seed) % (PREFILL * 3) + 1;
+			heap_Insert( globalHeap, dataPtr);
+			pthread_mutex_unlock( &globalLock);
+		}
+	}
+	return NULL;
+}
+
+/* Runs threads workers on the global heap or on the queue
+return pop+push pairs per second
+*/
+static double run(int threads, int useQueue)
+{
+	pthread_t tid[threads];
+	WORKER w[threads];
+	double start;
+
+	start = now();
+	for (int i = 0; i < threads; i++)
+	{
+		w[i].seed = 2463534242u + i * 7919;
+		w[i].ops = OPS;
+		w[i].useQueue = useQueue;
+		pthread_create( &tid[i], NULL, worker, &w[i]);
+	}
+	for (int i = 0; i < threads; i++)
+	{
+		pthread_join( tid[i], NULL);
+	}
+	return (double)threads * OPS / (now() - start);
+}
+
+int main(int argc, char **argv)
+{
+	int maxThreads = (int)sysconf( _SC_NPROCESSORS_ONLN);
+	int *data;
+	int *dataPtr;
+	unsigned int seed = 88675123u;
+
+	if (argc == 2) maxThreads = atoi(argv[1]);
+	if (argc > 2 || maxThreads <= 0)
+	{
+		fprintf( stderr, "usage: %s [threads]\n", argv[0]);
+		return 1;
+	}
+
+	data = (int *)malloc( sizeof(int) * PREFILL);
+	if (!data)
+	{
+		fprintf( stderr, "Cannot allocate memory!\n");
+		return 1;
+	}
+
+	fprintf( stdout, "%8s %14s %14s (pop+push per sec)\n", "threads", "global lock", "multiqueue");
+	// 1, 2, 4 ~ and maxThreads itself when it is not a power of 2
+	for (int threads = 1; threads <= maxThreads; threads = (threads < maxThreads && threads * 2 > maxThreads) ? maxThreads : threads * 2)
+	{
+		globalHeap = heap_Create( PREFILL, 4, compare);
+		queue = mqueue_Create( threads * LANES, PREFILL / (threads * LANES) + 1, compare);
+		if (!globalHeap || !queue)
+		{
+			fprintf( stderr, "Cannot allocate memory!\n");
+			return 1;
+		}
+
+		for (int i = 0; i < PREFILL; i++)
+		{
+			data[i] = next_random( &seed) % (PREFILL * 3) + 1;
+			heap_Insert( globalHeap, &data[i]);
+		}
+		double locked = run( threads, 0);
+
+		// same data is moved to the queue
+		while (heap_Delete( globalHeap, (void **)&dataPtr))
+		{
+			mqueue_Insert( queue, dataPtr);
+		}
+		double relaxed = run( threads, 1);
+
+		fprintf( stdout, "%8d %14.0f %14.0f\n", threads, locked, relaxed);
+
+		// data is owned by the benchmark, not by the queue
+		while (mqueue_Delete( queue, (void **)&dataPtr));
+		heap_Destroy( globalHeap);
+		mqueue_Destroy( queue);
+	}
+	free(data);
+
+	return 0;
+}
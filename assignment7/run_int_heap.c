@@ -28,7 +28,7 @@ int main(void)
 	int *dataPtr;
 	int i;
 	
-	heap = heap_Create( 10, compare);
+	heap = heap_Create( 10, 2, compare); // binary heap
 	
 	srand( time(NULL));
 	
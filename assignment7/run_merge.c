@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <string.h> // strcmp, strdup
+#include <stdlib.h>
+#include "adt_heap.h"
+
+/* user-defined compare function */
+int compare(void *arg1, void *arg2)
+{
+	return strcmp((char *)arg1, (char *)arg2);
+}
+
+/* reads the next word of a sorted file
+return 1 if successful; 0 at end of file
+*/
+int next_word(void *cursor, void **dataOutPtr)
+{
+	char data[1024];
+
+	if (fscanf( (FILE *)cursor, "%1023s", data) != 1) return 0;
+	*dataOutPtr = strdup(data);
+	return (*dataOutPtr != NULL);
+}
+
+/* prints and releases a merged word */
+void emit_word(void *data)
+{
+	printf( "%s\n", (char *)data);
+	free(data);
+}
+
+/* Sorts the words of one file in memory with heap_Sort
+(used to make the sorted runs that are merged later)
+return 0 if successful; 1 if memory overflow
+*/
+static int sort_file(FILE *fp)
+{
+	char data[1024];
+	int count = 0, size = 1024, failed = 0;
+	void **items = (void **)malloc( sizeof(void *) * size);
+
+	while (items && fscanf( fp, "%1023s", data) == 1)
+	{
+		if (count == size)
+		{
+			void **tmp = (void **)realloc( items, sizeof(void *) * size * 2);
+			if (!tmp)
+			{
+				failed = 1;
+				break;
+			}
+			items = tmp;
+			size *= 2;
+		}
+		if ((items[count] = strdup(data)) == NULL)
+		{
+			failed = 1;
+			break;
+		}
+		count++;
+	}
+	if (!items || failed)
+	{
+		for (int i = 0; i < count; i++) free(items[i]);
+		free(items);
+		return 1;
+	}
+
+	heap_Sort( items, count, compare);
+
+	for (int i = 0; i < count; i++)
+	{
+		emit_word( items[i]);
+	}
+	free(items);
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int main( int argc, char **argv)
+{
+	FILE **files;
+	int k;
+	int ret;
+
+	if (argc == 3 && strcmp( argv[1], "-s") == 0)
+	{
+		FILE *fp = fopen( argv[2], "rt");
+		if (fp == NULL)
+		{
+			fprintf( stderr, "file open error: %s\n", argv[2]);
+			return 1;
+		}
+		ret = sort_file( fp);
+		fclose( fp);
+		if (ret) fprintf( stderr, "Cannot allocate memory!\n");
+		return ret;
+	}
+
+	if (argc < 2)
+	{
+		fprintf( stderr, "usage: %s SORTED_FILE...\n", argv[0]);
+		fprintf( stderr, "       %s -s FILE\n", argv[0]);
+		return 1;
+	}
+
+	k = argc - 1;
+	files = (FILE **)malloc( sizeof(FILE *) * k);
+	if (!files)
+	{
+		fprintf( stderr, "Cannot allocate memory!\n");
+		return 1;
+	}
+
+	for (int i = 0; i < k; i++)
+	{
+		if ((files[i] = fopen( argv[i + 1], "rt")) == NULL)
+		{
+			fprintf( stderr, "file open error: %s\n", argv[i + 1]);
+			return 1;
+		}
+	}
+
+	// every file is read one word at a time, so memory does not depend on file sizes
+	ret = heap_Merge( (void **)files, k, next_word, compare, emit_word);
+	if (!ret) fprintf( stderr, "Cannot allocate memory!\n");
+
+	for (int i = 0; i < k; i++)
+	{
+		fclose( files[i]);
+	}
+	free(files);
+
+	return ret ? 0 : 1;
+}
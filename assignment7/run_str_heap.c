@@ -1,3 +1,5 @@
+#define SHOW_STEP 1 // 0: bulk load with heap_BuildFrom and print only the deleted order
+
 #include <stdio.h>
 #include <string.h> // strdup
 #include <stdlib.h>
@@ -15,18 +17,250 @@ void print_func(void *data)
 	printf( "%s ", (char *)data);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Top-k mode
+
+#define HASH_SIZE	1024 // initial number of buckets of the word counter
+
+/* word and its frequency */
+typedef struct entry
+{
+	char			*word;
+	int				count;
+	struct entry	*next; // next entry in the same bucket
+} ENTRY;
+
+/* word counter (chained hash table) */
+typedef struct
+{
+	ENTRY	**buckets;
+	int		size; // number of buckets
+	int		count; // number of distinct words
+} COUNTER;
+
+/* compare function of the top-k heap of words
+the smallest word comes to the root, so the root is the first one to drop
+*/
+int compare_min(void *arg1, void *arg2)
+{
+	return strcmp((char *)arg2, (char *)arg1);
+}
+
+/* compare function of the top-k heap of entries
+the least frequent entry (the larger word on ties) comes to the root
+*/
+int compare_freq(void *arg1, void *arg2)
+{
+	ENTRY *e1 = (ENTRY *)arg1;
+	ENTRY *e2 = (ENTRY *)arg2;
+
+	if (e1->count != e2->count) return (e1->count < e2->count) ? 1 : -1;
+	return strcmp(e1->word, e2->word);
+}
+
+/* djb2 string hash */
+static unsigned int hash(const char *str)
+{
+	unsigned int h = 5381;
+
+	while (*str) h = h * 33 + (unsigned char)*str++;
+	return h;
+}
+
+/* Increases the frequency of word, adding it if it is new
+return 1 if successful; 0 if memory overflow
+*/
+static int count_word(COUNTER *counter, const char *word)
+{
+	ENTRY *entry;
+	unsigned int index = hash( word) & (counter->size - 1);
+
+	for (entry = counter->buckets[index]; entry; entry = entry->next)
+	{
+		if (strcmp( entry->word, word) == 0)
+		{
+			entry->count++;
+			return 1;
+		}
+	}
+
+	// doubles the table when chains get long
+	if (counter->count >= counter->size * 2)
+	{
+		int size = counter->size * 2;
+		ENTRY **buckets = (ENTRY **)calloc( size, sizeof(ENTRY *));
+		if (!buckets) return 0;
+
+		for (int i = 0; i < counter->size; i++)
+		{
+			while ((entry = counter->buckets[i]) != NULL)
+			{
+				counter->buckets[i] = entry->next;
+				unsigned int newIndex = hash( entry->word) & (size - 1);
+				entry->next = buckets[newIndex];
+				buckets[newIndex] = entry;
+			}
+		}
+		free(counter->buckets);
+		counter->buckets = buckets;
+		counter->size = size;
+		index = hash( word) & (size - 1);
+	}
+
+	entry = (ENTRY *)malloc( sizeof(ENTRY));
+	if (!entry) return 0;
+	if ((entry->word = strdup(word)) == NULL)
+	{
+		free(entry);
+		return 0;
+	}
+	entry->count = 1;
+	entry->next = counter->buckets[index];
+	counter->buckets[index] = entry;
+	counter->count++;
+	return 1;
+}
+
+/* Keeps data in the heap if it is among the k best seen so far
+the root of the heap is the worst of the kept data
+return data that is dropped (NULL if none) so the caller can release it
+*/
+static void *push_bounded(HEAP *heap, int k, void *data)
+{
+	void *root;
+
+	if (heap_Count( heap) < k)
+	{
+		if (!heap_Insert( heap, data)) return data;
+		return NULL;
+	}
+	heap_Peek( heap, &root);
+	if (heap->compare( data, root) >= 0) return data;
+
+	heap_Replace( heap, data, &root);
+	return root;
+}
+
+/* Streams words of fp through a min heap holding at most k data
+and prints the k largest words (frequency 0)
+or the k most frequent words with their counts (frequency 1)
+frequency 0 keeps only k words; frequency 1 counts every distinct word first,
+so it needs memory proportional to the number of distinct words in fp
+return 0 if successful; 1 if memory overflow
+*/
+static int top_k(FILE *fp, int k, int frequency)
+{
+	HEAP *heap;
+	COUNTER counter = {NULL, HASH_SIZE, 0};
+	void **result;
+	char data[1024];
+	int count = 0, failed = 0;
+
+	heap = heap_Create( k, 4, frequency ? compare_freq : compare_min);
+	result = (void **)malloc( sizeof(void *) * k);
+	if (frequency) counter.buckets = (ENTRY **)calloc( counter.size, sizeof(ENTRY *));
+	if (!heap || !result || (frequency && !counter.buckets)) failed = 1;
+
+	if (!failed && frequency)
+	{
+		while (fscanf( fp, "%1023s", data) != EOF)
+		{
+			if (!count_word( &counter, data))
+			{
+				failed = 1;
+				break;
+			}
+		}
+		for (int i = 0; !failed && i < counter.size; i++)
+		{
+			for (ENTRY *entry = counter.buckets[i]; entry; entry = entry->next)
+			{
+				push_bounded( heap, k, entry); // entries are owned by the counter
+			}
+		}
+	}
+	else if (!failed)
+	{
+		while (fscanf( fp, "%1023s", data) != EOF)
+		{
+			char *word = strdup(data);
+			if (!word)
+			{
+				failed = 1;
+				break;
+			}
+			free(push_bounded( heap, k, word));
+		}
+	}
+
+	// the heap gives the worst first
+	while (heap && !heap_Empty( heap))
+	{
+		heap_Delete( heap, &result[count++]);
+	}
+	for (int i = count - 1; i >= 0; i--)
+	{
+		if (!failed)
+		{
+			if (frequency) printf( "%s %d\n", ((ENTRY *)result[i])->word, ((ENTRY *)result[i])->count);
+			else printf( "%s\n", (char *)result[i]);
+		}
+		if (!frequency) free(result[i]);
+	}
+
+	if (counter.buckets)
+	{
+		for (int i = 0; i < counter.size; i++)
+		{
+			ENTRY *entry;
+			while ((entry = counter.buckets[i]) != NULL)
+			{
+				counter.buckets[i] = entry->next;
+				free(entry->word);
+				free(entry);
+			}
+		}
+		free(counter.buckets);
+	}
+	free(result);
+	if (heap) heap_Destroy( heap);
+	return failed;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 int main( int argc, char **argv)
 {
 	HEAP *heap;
-	char *newdata;
 	char *dataPtr;
 	
 	char data[1024];
 	
+	if ((argc == 4 || argc == 5) && strcmp( argv[1], "-k") == 0 && atoi( argv[2]) > 0)
+	{
+		int frequency = (argc == 5 && strcmp( argv[3], "-f") == 0);
+		FILE *fp;
+
+		if (argc == 5 && !frequency)
+		{
+			fprintf( stderr, "usage: %s -k K [-f] FILE\n", argv[0]);
+			return 1;
+		}
+		if ((fp = fopen(argv[argc - 1], "rt")) == NULL)
+		{
+			fprintf( stderr, "file open error: %s\n", argv[argc - 1]);
+			return 1;
+		}
+		int ret = top_k( fp, atoi( argv[2]), frequency);
+		fclose( fp);
+		if (ret) fprintf( stderr, "Cannot allocate memory!\n");
+		return ret;
+	}
+
 	if (argc != 2)
 	{
 		fprintf( stderr, "usage: %s FILE\n", argv[0]);
+		fprintf( stderr, "       %s -k K [-f] FILE\n", argv[0]);
+		fprintf( stderr, "       (-f counts every distinct word, so its memory grows with the vocabulary)\n");
 		return 1;
 	}
 	
@@ -38,19 +272,57 @@ int main( int argc, char **argv)
 		return 1;
 	}
 	
-	heap = heap_Create( 10, compare); // initial capacity = 10
+#if SHOW_STEP
+	heap = heap_Create( 10, 2, compare); // initial capacity = 10, binary heap
 	
 	while (fscanf( fp, "%s", data) != EOF)
 	{
 		fprintf( stdout, "Inserting %s: ", data);
 		
-		newdata = strdup(data);
+		char *newdata = strdup(data);
 		
 		// insert function call
 		if (heap_Insert( heap, newdata) == 0) break;
 		
 		heap_Print( heap, print_func);
  	}
+#else
+	// reads every word first and builds the heap at once
+	int count = 0, size = 1024, failed = 0;
+	void **items = (void **)malloc( sizeof(void *) * size);
+	
+	while (items && fscanf( fp, "%s", data) != EOF)
+	{
+		if (count == size)
+		{
+			void **tmp = (void **)realloc( items, sizeof(void *) * size * 2);
+			if (!tmp)
+			{
+				failed = 1;
+				break;
+			}
+			items = tmp;
+			size *= 2;
+		}
+		if ((items[count] = strdup(data)) == NULL)
+		{
+			failed = 1;
+			break;
+		}
+		count++;
+	}
+	
+	heap = (items && !failed) ? heap_BuildFrom( items, count, 2, compare) : NULL;
+	if (!heap)
+	{
+		fprintf( stderr, "Cannot allocate memory!\n");
+		for (int i = 0; i < count; i++) free(items[i]);
+		free(items);
+		fclose( fp);
+		return 1;
+	}
+	free(items);
+#endif
 	
 	fclose( fp);
 
@@ -59,11 +331,17 @@ int main( int argc, char **argv)
 		// delete function call
 		heap_Delete( heap, (void **)&dataPtr);
 
+#if SHOW_STEP
 		printf( "Deleting  %s: ", dataPtr);
 
 		free(dataPtr);
 
 		heap_Print( heap, print_func);
+#else
+		printf( "%s\n", dataPtr);
+
+		free(dataPtr);
+#endif
  	}
 	
 	heap_Destroy( heap);
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h> // malloc, rand
+#include <time.h> // time
+
+#include "adt_iheap.h"
+
+#define MAX_TIMER	20
+
+typedef struct
+{
+	int	id;
+	int	expire; // expiration time
+} TIMER;
+
+/* user-defined compare function
+earlier expiration time comes to the root
+*/
+int compare(void *arg1, void *arg2)
+{
+	TIMER *t1 = (TIMER *)arg1;
+	TIMER *t2 = (TIMER *)arg2;
+
+	return t2->expire - t1->expire;
+}
+
+int main(void)
+{
+	IHEAP *heap;
+	TIMER *timer;
+	TIMER *timers[MAX_TIMER];
+	int handle[MAX_TIMER];
+	int i;
+
+	heap = iheap_Create( 10, compare);
+	if (!heap)
+	{
+		fprintf( stderr, "Cannot create heap!\n");
+		return 1;
+	}
+
+	srand( time(NULL));
+
+	for (i = 0; i < MAX_TIMER; i++)
+	{
+		timer = (TIMER *)malloc( sizeof(TIMER));
+		timer->id = i;
+		timer->expire = rand() % (MAX_TIMER * 3) + 1; // 1 ~ MAX_TIMER*3 random time
+		timers[i] = timer;
+
+		handle[i] = iheap_Insert( heap, timer);
+
+		fprintf( stdout, "Scheduling timer %2d at %2d\n", i, timer->expire);
+	}
+
+	// every third timer is rescheduled, every fifth timer is cancelled
+	for (i = 0; i < MAX_TIMER; i++)
+	{
+		if (i % 5 == 0)
+		{
+			iheap_Remove( heap, handle[i], (void **)&timer);
+			fprintf( stdout, "Cancelling timer %2d\n", timer->id);
+			free(timer);
+		}
+		else if (i % 3 == 0)
+		{
+			timer = timers[i];
+			timer->expire = rand() % (MAX_TIMER * 3) + 1;
+			iheap_Update( heap, handle[i], timer);
+			fprintf( stdout, "Rescheduling timer %2d at %2d\n", timer->id, timer->expire);
+		}
+	}
+
+	while (iheap_Peek( heap, (void **)&timer))
+	{
+		iheap_Delete( heap, (void **)&timer);
+
+		fprintf( stdout, "Firing timer %2d at %2d\n", timer->id, timer->expire);
+
+		free(timer);
+	}
+
+	iheap_Destroy( heap);
+
+	return 0;
+}
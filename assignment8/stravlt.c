@@ -1,28 +1,117 @@
 #define SHOW_STEP 0 // 제출시 0
 #define BALANCING 1 // 제출시 1 (used in _insert function)
+#define COUNTING 0 // 1: an existing key counts up its frequency instead of adding a node
+#define ARENA 1 // 1: nodes and their strings are allocated together from large blocks
 
 #include <stdlib.h> // malloc
 #include <stdio.h>
 #include <string.h> //strcmp, strdup
+#include <time.h> // clock
+#include <limits.h> // UINT_MAX
+#include <fcntl.h> // open
+#include <unistd.h> // close
+#include <sys/mman.h> // mmap
+#include <sys/stat.h> // fstat
+#include <pthread.h> // pthread_create
+#include "strword.h" // _prefix, _readWords, PREFIX_LEN
 
 #define max(x, y)	(((x) > (y)) ? (x) : (y))
 
+#define MAX_HEIGHT	64 // path stack size; an AVL tree of 2^31 nodes is at most 45 high
+#define BATCH_SIZE	8 // lookups advanced in lockstep by AVL_RetrieveBatch
+#define BATCH_ROUNDS	4 // timed rounds of each lookup method in batchQuery, after one warm-up
+#define ARENA_BLOCK	(1 << 20) // bytes of an arena block
+#define ARENA_ALIGN	8 // node sizes are rounded up to a multiple of ARENA_ALIGN
+#define ARENA_CLASSES	32 // deleted nodes up to ARENA_ALIGN * (ARENA_CLASSES - 1) bytes are reused
+
+#define CACHE_LINE	64 // bytes of a cache line; every reader slot gets its own
+#define RECLAIM_BATCH	256 // retired nodes between attempts to free them
+#define READ_MSEC	500 // duration of each run of the reader scaling benchmark
+
+#define SNAPSHOT_MAGIC	"AVL1"
+
+#if defined(__GNUC__)
+#define prefetch(p)	__builtin_prefetch(p)
+#else
+#define prefetch(p)
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 // AVL_TREE type definition
 typedef struct node
 {
+	unsigned long long	prefix; // first PREFIX_LEN bytes of data, big-endian and zero padded
 	char		*data;
 	struct node	*left;
 	struct node	*right;
 	int			height;
+	int			freq; // number of insertions of the key (always 1 without COUNTING)
 } NODE;
 
+// arena block; nodes are carved out of the bytes after the header
+typedef struct block
+{
+	struct block	*next;
+	size_t			size; // bytes after the header
+} BLOCK;
+
+// sharing state of a tree updated by AVL_InsertShared while other threads call AVL_RetrieveShared.
+// published nodes are never changed; a node replaced by a copy is retired with the epoch of
+// the replacement and freed once every reader inside AVL_RetrieveShared entered a later epoch
+typedef struct
+{
+	_Alignas(CACHE_LINE) unsigned long	epoch; // epoch the reader entered in (0 if outside)
+} READER_SLOT;
+
+typedef struct
+{
+	NODE			*node;
+	unsigned long	epoch; // epoch in which the node was replaced
+} RETIRED;
+
+typedef struct
+{
+	_Alignas(CACHE_LINE) unsigned long	epoch; // advanced by the writer before it looks for nodes to free
+	READER_SLOT	*slots;
+	int			readers; // number of slots
+	RETIRED		*retired; // replaced nodes, oldest first
+	int			retiredCount;
+	int			retiredCapacity;
+	int			reclaimAt; // retiredCount of the next attempt to free nodes
+} SHARED;
+
 typedef struct
 {
 	NODE	*root;
 	int		count;  // number of nodes
+	BLOCK	*blocks; // arena blocks (ARENA only)
+	char	*top; // next free byte of the newest block
+	char	*end; // end of the newest block
+	NODE	*freeList[ARENA_CLASSES]; // deleted nodes linked through left, by size / ARENA_ALIGN
+	char	*image; // mapped snapshot (NULL if the tree is in memory)
+	size_t	imageSize;
+	SHARED	*shared; // NULL until AVL_Share
 } AVL_TREE;
 
+// snapshot image written by AVL_Save: header, nodes in level order, then the strings.
+// children and strings are found by index and offset, so the image works at any address
+typedef struct
+{
+	char			magic[4];
+	unsigned int	count; // number of nodes
+	unsigned int	root; // index of the root + 1 (0 if empty)
+	int				height;
+} IMAGE_HEADER;
+
+typedef struct
+{
+	unsigned long long	prefix;
+	unsigned int	data; // offset of the string from the start of the image
+	unsigned int	left; // index of the left child + 1 (0 if none)
+	unsigned int	right;
+	int				freq;
+} IMAGE_NODE;
+
 ////////////////////////////////////////////////////////////////////////////////
 // Prototype declarations
 
@@ -35,21 +124,81 @@ AVL_TREE *AVL_Create( void);
 /* Deletes all data in tree and recycles memory
 */
 void AVL_Destroy( AVL_TREE *pTree);
-static void _destroy( NODE *root);
+static void _destroy( AVL_TREE *pTree, NODE *root);
+
+/* Builds a perfectly balanced tree from words sorted by strcmp in O(n)
+	with COUNTING, equal neighbors become one node
+	return	head node pointer
+			NULL if overflow
+*/
+AVL_TREE *AVL_BuildFromSorted( char **words, int n);
+
+/* internal function
+	Makes the middle run of runs[lo] ~ runs[hi - 1] the root and builds both halves below it
+	run k holds words[runs[k]] ~ words[runs[k + 1] - 1]
+	return	pointer to root
+			NULL if empty or overflow
+*/
+static NODE *_buildFromSorted( AVL_TREE *pTree, char **words, int *runs, int lo, int hi);
 
 /* Inserts new data into the tree
+	with COUNTING, an existing key only counts up its frequency
 	return	1 success
-			0 overflow
+			0 overflow, the tree is a loaded snapshot or shared
 */
 int AVL_Insert( AVL_TREE *pTree, char *data);
 
 /* internal function
-	This function uses recursion to insert the new data into a leaf node
+	This function inserts the new data into a leaf node without recursion.
+	The path from the root is recorded on a stack and walked back up
+	only while the height of the subtree keeps changing
+	added is 1 if a node is added; 0 if the frequency of an existing node is counted up
+	return	pointer to new root
+			NULL if overflow (the tree is not changed)
+*/
+static NODE *_insert( AVL_TREE *pTree, NODE *root, char *data, int *added);
+
+/* internal function
+	Rotates the subtree if it is out of balance
+	return	new root of the subtree
+*/
+static NODE *_rebalance( NODE *root);
+
+/* internal function
+	Allocates a node with a copy of data;
+	with ARENA the string is stored right after the node in the same arena chunk
+	return	new node
+			NULL if overflow
+*/
+static NODE *_makeNode( AVL_TREE *pTree, char *data);
+static void _freeNode( AVL_TREE *pTree, NODE *node);
+
+/* internal function
+	Bump-allocates size bytes from the newest arena block
+	or reuses a deleted node of the same size class
+	return	address of the memory
+			NULL if overflow
+*/
+static void *_arenaAlloc( AVL_TREE *pTree, size_t size);
+
+/* Deletes a node with key from the tree
+	with COUNTING, the node is deleted when its frequency drops to 0
+	return	1 success
+			0 not found, the tree is a loaded snapshot or shared
+*/
+int AVL_Delete( AVL_TREE *pTree, char *key);
+
+/* internal function
+	success is 1 if deleted; 0 if not
 	return	pointer to new root
 */
-static NODE *_insert( NODE *root, NODE *newPtr);
+static NODE *_delete( AVL_TREE *pTree, NODE *root, unsigned long long prefix, char *key, int *success);
 
-static NODE *_makeNode( char *data);
+/* internal function
+	Detaches the leftmost node of the tree and passes it back in minPtr
+	return	pointer to new root
+*/
+static NODE *_deleteMin( NODE *root, NODE **minPtr);
 
 /* Retrieve tree for the node containing the requested key
 	return	address of data of the node containing the key
@@ -64,11 +213,121 @@ char *AVL_Retrieve( AVL_TREE *pTree, char *key);
 */
 static NODE *_retrieve( NODE *root, char *key);
 
+/* internal function
+	Retrieve node of the snapshot image containing the requested key
+	return	address of the image node containing the key
+			NULL not found
+*/
+static IMAGE_NODE *_retrieveImage( AVL_TREE *pTree, char *key);
+
+/* internal function
+	Checks that a comparison can read the string of the image node without leaving the image;
+	the string is read past the cached prefix only if the prefix has no zero byte
+	return	1 if it can be read
+			0 if the image is damaged
+*/
+static int _imageDataValid( AVL_TREE *pTree, IMAGE_NODE *node);
+
+/* Counts the insertions of the key
+	return	frequency of the key
+			0 not found
+*/
+int AVL_Frequency( AVL_TREE *pTree, char *key);
+
+/* Retrieves n keys at once, passing back data of each key (NULL if not found) in results.
+	Up to BATCH_SIZE lookups go down the tree in turns, prefetching the next node of each
+	so that their cache misses overlap
+	return	number of keys found
+*/
+int AVL_RetrieveBatch( AVL_TREE *pTree, char **keys, int n, char **results);
+
+/*
+	return	height of the tree
+*/
+int AVL_Height( AVL_TREE *pTree);
+
+/* Writes the tree to a snapshot image file
+	return	1 success
+			0 file error or overflow
+*/
+int AVL_Save( AVL_TREE *pTree, const char *filename);
+
+/* Maps a snapshot image written by AVL_Save and uses it without rebuilding the tree.
+	The loaded tree is read-only: AVL_Retrieve, AVL_RetrieveBatch, AVL_Frequency, AVL_PrefixTraverse,
+	AVL_Height and AVL_Save read the image; the other functions see an empty tree
+	return	head node pointer
+			NULL if the file is not a snapshot or overflow
+*/
+AVL_TREE *AVL_Load( const char *filename);
+
+/* Prepares the tree for one writer thread calling AVL_InsertShared
+	while up to readers threads call AVL_RetrieveShared without locks.
+	AVL_Insert and AVL_Delete fail on a shared tree
+	return	1 success
+			0 overflow, the tree is a loaded snapshot or already shared
+*/
+int AVL_Share( AVL_TREE *pTree, int readers);
+
+/* Inserts new data like AVL_Insert without changing any node a reader can see:
+	the path from the root is copied, the new root is published atomically
+	and the replaced nodes are retired until no reader can hold them.
+	only one thread may call it at a time
+	return	1 success
+			0 overflow or the tree is not shared
+*/
+int AVL_InsertShared( AVL_TREE *pTree, char *data);
+
+/* Retrieve like AVL_Retrieve, safe while AVL_InsertShared runs in another thread
+	reader is the slot of the calling thread (0 ~ readers - 1); no two threads use the same slot
+	return	address of data of the node containing the key (valid until the tree is destroyed)
+			NULL not found
+*/
+char *AVL_RetrieveShared( AVL_TREE *pTree, int reader, char *key);
+
+/* internal function
+	Allocates a copy of the node that shares its string
+	return	new node
+			NULL if overflow
+*/
+static NODE *_copyNode( AVL_TREE *pTree, NODE *node);
+
+/* internal function
+	Frees a node whose string belongs to another node (a copy or a replaced node)
+*/
+static void _releaseNode( AVL_TREE *pTree, NODE *node);
+
+/* internal function
+	Advances the epoch and frees the retired nodes that no reader can hold any more
+*/
+static void _reclaim( AVL_TREE *pTree);
+
 /* Prints tree using inorder traversal
 */
 void AVL_Traverse( AVL_TREE *pTree);
 static void _traverse( NODE *root);
 
+/* Visits nodes whose data lies in [lo, hi] in ascending order
+	subtrees entirely outside the range are not visited
+*/
+void AVL_RangeTraverse( AVL_TREE *pTree, char *lo, char *hi, void (*callback)(char *data));
+static void _rangeTraverse( NODE *root, unsigned long long loPrefix, char *lo,
+	unsigned long long hiPrefix, char *hi, void (*callback)(char *data));
+
+/* Visits nodes whose data starts with prefix in ascending order
+	subtrees without such data are not visited
+*/
+void AVL_PrefixTraverse( AVL_TREE *pTree, char *prefix, void (*callback)(char *data));
+static void _prefixTraverse( NODE *root, unsigned long long keyPrefix, unsigned long long mask,
+	char *prefix, int len, void (*callback)(char *data));
+static void _prefixTraverseImage( AVL_TREE *pTree, unsigned int i, int level, unsigned long long keyPrefix,
+	unsigned long long mask, char *prefix, int len, void (*callback)(char *data));
+
+/* Seeks the smallest key not less than key
+	return	address of data of the node
+			NULL if all keys are less than key
+*/
+char *AVL_LowerBound( AVL_TREE *pTree, char *key);
+
 /* Prints tree using inorder right-to-left traversal
 */
 void printTree( AVL_TREE *pTree);
@@ -76,11 +335,39 @@ void printTree( AVL_TREE *pTree);
 */
 static void _infix_print( NODE *root, int level);
 
+/* Prints data followed by a space
+	callback of AVL_RangeTraverse and AVL_PrefixTraverse
+*/
+static void printWord( char *data);
+
 /* internal function
 	return	height of the (sub)tree from the node (root)
 */
 static int getHeight( NODE *root);
 
+/* internal function
+	Compares the key with data of the node,
+	reading the strings only if the prefixes are the same
+	return	negative, 0 or positive like strcmp
+*/
+static int _compare( unsigned long long prefix, const char *key, NODE *node);
+
+/* internal function
+	Compares the key with data whose prefix is dataPrefix,
+	reading the strings only if the prefixes are the same
+	return	negative, 0 or positive like strcmp
+*/
+static int _compareData( unsigned long long prefix, const char *key, unsigned long long dataPrefix, const char *data);
+
+/* internal function
+	Compares the first len bytes of data whose prefix is dataPrefix with prefix (len bytes),
+	reading the string only if the cached prefixes are the same
+	mask selects the first len bytes of a cached prefix
+	return	negative, 0 or positive like strncmp
+*/
+static int _comparePrefix( unsigned long long keyPrefix, unsigned long long mask,
+	const char *prefix, int len, unsigned long long dataPrefix, const char *data);
+
 /* internal function
 	Exchanges pointers to rotate the tree to the right
 	updates heights of the nodes
@@ -95,50 +382,156 @@ static NODE *rotateRight( NODE *root);
 */
 static NODE *rotateLeft( NODE *root);
 
+////////////////////////////////////////////////////////////////////////////////
+// Benchmark mode
+
+/*
+	return	1 if words are sorted by strcmp; 0 if not
+*/
+static int _isSorted( char **words, int n);
+
+/* xorshift64* pseudo random number generator
+	return	32 random bits
+*/
+static unsigned int _random( void);
+
+/* Inserts all words, then deletes or reinserts a random word n times
+	and reports throughput, tree height and number of nodes
+	return	0 success
+			1 overflow or tree corrupted
+*/
+static int churn( char **words, int count, int n);
+
+/* Looks up all keys with AVL_RetrieveBatch and prints the results,
+	then reports time per key against one AVL_Retrieve per key
+	both methods get an untimed warm-up pass, then BATCH_ROUNDS timed passes in alternating order
+	return	0 success
+			1 overflow or results differ
+*/
+static int batchQuery( AVL_TREE *tree, char **keys, int n);
+
+/* For 1, 2, 4 ~ threads readers: builds a tree of the even words, then runs the readers
+	for READ_MSEC while one writer inserts the odd words with AVL_InsertShared,
+	and reports lookups per second of all readers
+	return	0 success
+			1 overflow or a word went missing
+*/
+static int readScaling( char **words, int count, int threads);
+
 ////////////////////////////////////////////////////////////////////////////////
 int main( int argc, char **argv)
 {
 	AVL_TREE *tree;
 	char str[1024];
+	char *file = argv[1];
+	char *queryFile = NULL;
+	char *snapshotFile = NULL;
 	
-	if (argc != 2)
+	if (argc == 4 && (strcmp( argv[1], "-c") == 0 || strcmp( argv[1], "-r") == 0) && atoi( argv[3]) > 0)
 	{
-		fprintf( stderr, "Usage: %s FILE\n", argv[0]);
-		return 0;
+		FILE *fp = fopen( argv[2], "rt");
+		char **words;
+		int count, ret;
+
+		if (fp == NULL)
+		{
+			fprintf( stderr, "Cannot open file! [%s]\n", argv[2]);
+			return 200;
+		}
+		words = _readWords( fp, &count);
+		fclose( fp);
+		if (!words)
+		{
+			fprintf( stderr, "Cannot read words!\n");
+			return 100;
+		}
+		if (argv[1][1] == 'c') ret = churn( words, count, atoi( argv[3]));
+		else ret = readScaling( words, count, atoi( argv[3]));
+		for (int i = 0; i < count; i++) free(words[i]);
+		free(words);
+		return ret;
 	}
-	
-	// creates a null tree
-	tree = AVL_Create();
-	
-	if (!tree)
+
+	if (argc == 4 && strcmp( argv[1], "-q") == 0)
 	{
-		fprintf( stderr, "Cannot create tree!\n");
-		return 100;
+		file = argv[2];
+		queryFile = argv[3];
 	}
-
-	FILE *fp = fopen( argv[1], "rt");
+	else if (argc == 4 && strcmp( argv[1], "-s") == 0)
+	{
+		snapshotFile = argv[2];
+		file = argv[3];
+	}
+	else if (argc != 2)
+	{
+		fprintf( stderr, "Usage: %s FILE or %s SNAPSHOT\n", argv[0], argv[0]);
+		fprintf( stderr, "       %s -c FILE number\n", argv[0]);
+		fprintf( stderr, "       %s -r FILE threads\n", argv[0]);
+		fprintf( stderr, "       %s -q FILE QUERY_FILE\n", argv[0]);
+		fprintf( stderr, "       %s -s SNAPSHOT FILE\n", argv[0]);
+		return 0;
+	}
+	
+	FILE *fp = fopen( file, "rt");
 	if (fp == NULL)
 	{
-		fprintf( stderr, "Cannot open file! [%s]\n", argv[1]);
+		fprintf( stderr, "Cannot open file! [%s]\n", file);
 		return 200;
 	}
 
-	while(fscanf( fp, "%s", str) != EOF)
+	int count;
+	char **words;
+
+	// a snapshot is mapped and used as it is
+	if ((tree = AVL_Load( file)) != NULL)
+	{
+		fclose( fp);
+	}
+	else
 	{
+		words = _readWords( fp, &count);
+		fclose( fp);
+		if (!words)
+		{
+			fprintf( stderr, "Cannot read words!\n");
+			return 100;
+		}
+
+		// sorted input is built bottom-up without rotations
+		if (!SHOW_STEP && _isSorted( words, count))
+		{
+			tree = AVL_BuildFromSorted( words, count);
+		}
+		else
+		{
+			// creates a null tree
+			tree = AVL_Create();
+
+			for (int i = 0; tree && i < count; i++)
+			{
 
 #if SHOW_STEP
-		fprintf( stdout, "Insert %s>\n", str);
+				fprintf( stdout, "Insert %s>\n", words[i]);
 #endif		
-		// insert function call
-		AVL_Insert( tree, str);
+				// insert function call
+				AVL_Insert( tree, words[i]);
 
 #if SHOW_STEP
-		fprintf( stdout, "Tree representation:\n");
-		printTree( tree);
+				fprintf( stdout, "Tree representation:\n");
+				printTree( tree);
 #endif
+			}
+		}
+
+		for (int i = 0; i < count; i++) free(words[i]);
+		free(words);
+	}
+
+	if (!tree)
+	{
+		fprintf( stderr, "Cannot create tree!\n");
+		return 100;
 	}
-	
-	fclose( fp);
 	
 #if SHOW_STEP
 	fprintf( stdout, "\n");
@@ -153,17 +546,66 @@ int main( int argc, char **argv)
 	printTree(tree);
 #endif
 
-	fprintf( stdout, "Height of tree: %d\n", tree->root->height);
+	fprintf( stdout, "Height of tree: %d\n", AVL_Height( tree));
 	fprintf( stdout, "# of nodes: %d\n", tree->count);
+
+	if (snapshotFile)
+	{
+		int ret = AVL_Save( tree, snapshotFile);
+		AVL_Destroy( tree);
+		if (!ret)
+		{
+			fprintf( stderr, "Cannot write snapshot! [%s]\n", snapshotFile);
+			return 200;
+		}
+		fprintf( stdout, "Saved to %s\n", snapshotFile);
+		return 0;
+	}
+
+	// bulk retrieval
+	if (queryFile)
+	{
+		int ret;
+
+		if ((fp = fopen( queryFile, "rt")) == NULL)
+		{
+			fprintf( stderr, "Cannot open file! [%s]\n", queryFile);
+			return 200;
+		}
+		words = _readWords( fp, &count);
+		fclose( fp);
+		if (!words)
+		{
+			fprintf( stderr, "Cannot read words!\n");
+			return 100;
+		}
+		ret = batchQuery( tree, words, count);
+		for (int i = 0; i < count; i++) free(words[i]);
+		free(words);
+		AVL_Destroy( tree);
+		return ret;
+	}
 	
 	// retrieval
 	char *key;
 	fprintf( stdout, "Query: ");
-	while( fscanf( stdin, "%s", str) != EOF)
+	while( fscanf( stdin, "%1023s", str) != EOF)
 	{
+		int len = strlen( str);
+
+		// a query ending with * lists the words starting with it
+		if (len > 0 && str[len - 1] == '*')
+		{
+			str[len - 1] = '\0';
+			AVL_PrefixTraverse( tree, str, printWord);
+			fprintf( stdout, "\nQuery: ");
+			continue;
+		}
+
 		key = AVL_Retrieve( tree, str);
 		
-		if (key) fprintf( stdout, "%s found!\n", key);
+		if (key && COUNTING) fprintf( stdout, "%s found! (%d times)\n", key, AVL_Frequency( tree, key));
+		else if (key) fprintf( stdout, "%s found!\n", key);
 		else fprintf( stdout, "%s NOT found!\n", str);
 		
 		fprintf( stdout, "Query: ");
@@ -185,8 +627,16 @@ int main( int argc, char **argv)
 */
 AVL_TREE *AVL_Create( void) {
 	AVL_TREE *newTree = (AVL_TREE *) malloc (sizeof(AVL_TREE));
+	if (!newTree) return NULL;
 	newTree->root = NULL;
 	newTree->count = 0;
+	newTree->blocks = NULL;
+	newTree->top = NULL;
+	newTree->end = NULL;
+	for (int i = 0; i < ARENA_CLASSES; i++) newTree->freeList[i] = NULL;
+	newTree->image = NULL;
+	newTree->imageSize = 0;
+	newTree->shared = NULL;
 
 	return newTree;
 }
@@ -194,143 +644,865 @@ AVL_TREE *AVL_Create( void) {
 /* Deletes all data in tree and recycles memory
 */
 void AVL_Destroy( AVL_TREE *pTree) {
-	if (pTree->root) {
-        _destroy(pTree->root);
+	if (pTree->image) {
+		munmap(pTree->image, pTree->imageSize);
+	}
+	if (pTree->shared) {
+		// no reader is left, so every retired node can go
+		for (int i = 0; i < pTree->shared->retiredCount; i++) {
+			_releaseNode(pTree, pTree->shared->retired[i].node);
+		}
+		free(pTree->shared->retired);
+		free(pTree->shared->slots);
+		free(pTree->shared);
+	}
+	if (ARENA) {
+		// nodes are not visited; the blocks go back as a whole
+		while (pTree->blocks) {
+			BLOCK *next = pTree->blocks->next;
+			free(pTree->blocks);
+			pTree->blocks = next;
+		}
+	}
+	else if (pTree->root) {
+        _destroy(pTree, pTree->root);
     }
     free(pTree);
 }
-static void _destroy( NODE *root) {
+static void _destroy( AVL_TREE *pTree, NODE *root) {
 	if (!root) return;
     else {
-        _destroy(root->left);
-        _destroy(root->right);
-		free(root->data);
-        free(root);
+        _destroy(pTree, root->left);
+        _destroy(pTree, root->right);
+		_freeNode(pTree, root);
     }
 }
 
+/* Builds a perfectly balanced tree from words sorted by strcmp in O(n)
+	with COUNTING, equal neighbors become one node
+	return	head node pointer
+			NULL if overflow
+*/
+AVL_TREE *AVL_BuildFromSorted( char **words, int n) {
+	AVL_TREE *newTree = AVL_Create();
+	int *runs = (int *) malloc (sizeof(int) * (n + 1));
+	int runCount = 0;
+
+	if (!newTree || !runs) {
+		free(newTree);
+		free(runs);
+		return NULL;
+	}
+
+	for (int i = 0; i < n; i++) {
+		if (!COUNTING || i == 0 || strcmp(words[i - 1], words[i]) != 0) runs[runCount++] = i;
+	}
+	runs[runCount] = n;
+
+	newTree->root = _buildFromSorted(newTree, words, runs, 0, runCount);
+	free(runs);
+	if (!newTree->root && runCount > 0) {
+		AVL_Destroy(newTree);
+		return NULL;
+	}
+	newTree->count = runCount;
+
+	return newTree;
+}
+
+/* internal function
+	Makes the middle run of runs[lo] ~ runs[hi - 1] the root and builds both halves below it
+	run k holds words[runs[k]] ~ words[runs[k + 1] - 1]
+	return	pointer to root
+			NULL if empty or overflow
+*/
+static NODE *_buildFromSorted( AVL_TREE *pTree, char **words, int *runs, int lo, int hi) {
+	int mid = lo + (hi - lo) / 2;
+	NODE *root, *left, *right;
+
+	if (lo >= hi) return NULL;
+
+	root = _makeNode(pTree, words[runs[mid]]);
+	if (!root) return NULL;
+
+	// halves differ in size by at most one, so their heights differ by at most one
+	left = _buildFromSorted(pTree, words, runs, lo, mid);
+	right = _buildFromSorted(pTree, words, runs, mid + 1, hi);
+	if ((!left && lo < mid) || (!right && mid + 1 < hi)) {
+		_destroy(pTree, left);
+		_destroy(pTree, right);
+		_freeNode(pTree, root);
+		return NULL;
+	}
+
+	root->left = left;
+	root->right = right;
+	root->height = max(getHeight(left), getHeight(right)) + 1;
+	root->freq = runs[mid + 1] - runs[mid];
+
+	return root;
+}
+
 /* Inserts new data into the tree
+	with COUNTING, an existing key only counts up its frequency
 	return	1 success
-			0 overflow
+			0 overflow, the tree is a loaded snapshot or shared
 */
 int AVL_Insert( AVL_TREE *pTree, char *data) {
-	NODE *newPtr = _makeNode(data);
-    if (!newPtr ) return 0;
+	int added = 0;
+	NODE *root;
 
-	if (pTree->root == NULL) {
-        pTree->root = newPtr;
-		pTree->count++;
-        return 1;
-    }
+	if (pTree->image || pTree->shared) return 0; // a shared tree changes only through AVL_InsertShared
+	root = _insert(pTree, pTree->root, data, &added);
+	if (!root) return 0;
 
-	pTree->root = _insert(pTree->root, newPtr);
-	pTree->count++;
+	pTree->root = root;
+	pTree->count += added;
 	
 	return 1;
 }
 
 /* internal function
-	This function uses recursion to insert the new data into a leaf node
+	This function inserts the new data into a leaf node without recursion.
+	The path from the root is recorded on a stack and walked back up
+	only while the height of the subtree keeps changing
 	return	pointer to new root
 */
-static NODE *_insert( NODE *root, NODE *newPtr) {
-	if (!root) return newPtr;
-	//newPtr data가 root data보다 더 작다 -> left 삽입
-	if (strcmp(newPtr->data, root->data) < 0) {
-		if (root->left == NULL) {
-            root->left = newPtr;
-        }
-		else {
-			root->left = _insert(root->left, newPtr);
+static NODE *_insert( AVL_TREE *pTree, NODE *root, char *data, int *added) {
+	NODE *path[MAX_HEIGHT];
+	int top = 0;
+	NODE *node = root;
+	NODE *parent = NULL;
+	NODE *newPtr;
+	int depth = 0;
+	int cmp = 0;
+	unsigned long long prefix = _prefix(data);
+
+	//data가 node data보다 더 작다 -> left, 같거나 크다 -> right
+	// without balancing the tree can be deeper than the stack, so the path is not recorded
+	while (node) {
+		cmp = _compare(prefix, data, node);
+		if (COUNTING && cmp == 0) {
+			node->freq++;
+			*added = 0;
+			return root;
 		}
-		root->height = max(getHeight(root->left), getHeight(root->right)) + 1;
+		if (BALANCING) path[top++] = node;
+		parent = node;
+		node = (cmp < 0) ? node->left : node->right;
+		depth++;
 	}
-	// right 삽입
-	else {
-		if (root->right == NULL) {
-            root->right = newPtr;
-        }
-		else {
-			root->right = _insert(root->right, newPtr);
-			
+
+	newPtr = _makeNode(pTree, data);
+	if (!newPtr) return NULL;
+	*added = 1;
+
+	if (!parent) return newPtr;
+	if (cmp < 0) parent->left = newPtr;
+	else parent->right = newPtr;
+
+	if (!BALANCING) {
+		// the same comparisons lead to newPtr again; each node on the way is at least as high as its distance to newPtr
+		for (node = root; node != newPtr; depth--) {
+			node->height = max(node->height, depth + 1);
+			node = (_compare(prefix, data, node) < 0) ? node->left : node->right;
 		}
-		root->height = max(getHeight(root->left), getHeight(root->right)) + 1;
+		return root;
 	}
-	// balancing
-	if (BALANCING) {
-		int balanceCheck = getHeight(root->left) - getHeight(root->right);
 
-		//left high
-		if (balanceCheck > 1) {
-			// LL
-			if (getHeight(root->left->left) - getHeight(root->left->right) > 0) {
-				root = rotateRight(root);
-			}
-			// LR
-			else {
-				root->left = rotateLeft(root->left);
-				root = rotateRight(root);
-			}
+	while (top > 0) {
+		NODE *subRoot;
+		int oldHeight;
+
+		node = path[--top];
+		oldHeight = node->height;
+		node->height = max(getHeight(node->left), getHeight(node->right)) + 1;
+
+		subRoot = _rebalance(node);
+		if (subRoot != node) {
+			if (top == 0) root = subRoot;
+			else if (path[top - 1]->left == node) path[top - 1]->left = subRoot;
+			else path[top - 1]->right = subRoot;
+			// a rotation after insertion restores the old height of the subtree
+			break;
 		}
+		if (node->height == oldHeight) break;
+	}
 
-		//right high
-		else if (balanceCheck < -1) {
-			// RR
-			if (getHeight(root->right->left) - getHeight(root->right->right) < 0) {
-				root = rotateLeft(root);
-			}
-			// RL
-			else {
-				root->right = rotateRight(root->right);
-				root = rotateLeft(root);
-			}
+	return root;
+}
+
+/* internal function
+	Rotates the subtree if it is out of balance
+	return	new root of the subtree
+*/
+static NODE *_rebalance( NODE *root) {
+	int balanceCheck = getHeight(root->left) - getHeight(root->right);
+
+	//left high
+	if (balanceCheck > 1) {
+		// LL (a deletion can leave the left child balanced)
+		if (getHeight(root->left->left) - getHeight(root->left->right) >= 0) {
+			root = rotateRight(root);
+		}
+		// LR
+		else {
+			root->left = rotateLeft(root->left);
+			root = rotateRight(root);
+		}
+	}
+
+	//right high
+	else if (balanceCheck < -1) {
+		// RR
+		if (getHeight(root->right->left) - getHeight(root->right->right) <= 0) {
+			root = rotateLeft(root);
+		}
+		// RL
+		else {
+			root->right = rotateRight(root->right);
+			root = rotateLeft(root);
 		}
 	}
 
 	return root;
 }
 
-static NODE *_makeNode( char *data) {
-	NODE *newNode = (NODE *) malloc (sizeof(NODE));
+/* internal function
+	Allocates a node with a copy of data;
+	with ARENA the string is stored right after the node in the same arena chunk
+	return	new node
+			NULL if overflow
+*/
+static NODE *_makeNode( AVL_TREE *pTree, char *data) {
+	NODE *newNode;
+
+	if (ARENA) {
+		size_t len = strlen(data) + 1;
+
+		newNode = (NODE *) _arenaAlloc(pTree, sizeof(NODE) + len);
+		if (!newNode) return NULL;
+		newNode->data = (char *) (newNode + 1);
+		memcpy(newNode->data, data, len);
+	}
+	else {
+		newNode = (NODE *) malloc (sizeof(NODE));
+		if (!newNode) return NULL;
+		newNode->data = strdup(data);
+		if (!newNode->data) {
+			free(newNode);
+			return NULL;
+		}
+	}
 	newNode->left = NULL;
 	newNode->right = NULL;
 	newNode->height = 1;
-	newNode->data = strdup(data);
+	newNode->freq = 1;
+	newNode->prefix = _prefix(data);
 	return newNode;
 }
 
-/* Retrieve tree for the node containing the requested key
-	return	address of data of the node containing the key
-			NULL not found
-*/
-char *AVL_Retrieve( AVL_TREE *pTree, char *key) {
-	if (pTree->root) {
-		NODE *foundNode = _retrieve(pTree->root, key);
-		if (foundNode) return foundNode->data;
-		else return NULL;
+static void _freeNode( AVL_TREE *pTree, NODE *node) {
+	if (ARENA) {
+		// a copy made by AVL_InsertShared has its string in the node it was copied from
+		size_t len = (node->data == (char *) (node + 1)) ? strlen(node->data) + 1 : 0;
+		size_t size = (sizeof(NODE) + len + ARENA_ALIGN - 1) / ARENA_ALIGN;
+
+		// longer nodes stay in their block until the tree is destroyed
+		if (size < ARENA_CLASSES) {
+			node->left = pTree->freeList[size];
+			pTree->freeList[size] = node;
+		}
+		return;
 	}
+	free(node->data);
+	free(node);
 }
 
 /* internal function
-	Retrieve node containing the requested key
-	return	address of the node containing the key
-			NULL not found
+	Bump-allocates size bytes from the newest arena block
+	or reuses a deleted node of the same size class
+	return	address of the memory
+			NULL if overflow
 */
-static NODE *_retrieve( NODE *root, char *key) {
-	if (root) {
-		if (strcmp(root->data,key) > 0) {
-			return _retrieve(root->left, key);
+static void *_arenaAlloc( AVL_TREE *pTree, size_t size) {
+	char *chunk;
+
+	size = (size + ARENA_ALIGN - 1) / ARENA_ALIGN;
+	if (size < ARENA_CLASSES && pTree->freeList[size]) {
+		NODE *node = pTree->freeList[size];
+		pTree->freeList[size] = node->left;
+		return node;
+	}
+	size *= ARENA_ALIGN;
+
+	if (pTree->top == NULL || (size_t) (pTree->end - pTree->top) < size) {
+		// the rest of the old block is left unused
+		size_t blockSize = (size > ARENA_BLOCK) ? size : ARENA_BLOCK;
+		BLOCK *newBlock = (BLOCK *) malloc (sizeof(BLOCK) + blockSize);
+		if (!newBlock) return NULL;
+
+		newBlock->next = pTree->blocks;
+		newBlock->size = blockSize;
+		pTree->blocks = newBlock;
+		pTree->top = (char *) (newBlock + 1);
+		pTree->end = pTree->top + blockSize;
+	}
+
+	chunk = pTree->top;
+	pTree->top += size;
+	return chunk;
+}
+
+/* Deletes a node with key from the tree
+	with COUNTING, the node is deleted when its frequency drops to 0
+	return	1 success
+			0 not found, the tree is a loaded snapshot or shared
+*/
+int AVL_Delete( AVL_TREE *pTree, char *key) {
+	int success = 0;
+
+	if (pTree->image || pTree->shared) return 0; // readers may be walking the nodes it would change
+
+	if (COUNTING) {
+		NODE *node = _retrieve(pTree->root, key);
+		if (node && node->freq > 1) {
+			node->freq--;
+			return 1;
 		}
-		else if (strcmp(root->data, key) <0) {
-			return _retrieve(root->right, key);
+	}
+
+	pTree->root = _delete(pTree, pTree->root, _prefix(key), key, &success);
+	if (success) pTree->count--;
+
+	return success;
+}
+
+/* internal function
+	success is 1 if deleted; 0 if not
+	return	pointer to new root
+*/
+static NODE *_delete( AVL_TREE *pTree, NODE *root, unsigned long long prefix, char *key, int *success) {
+	int cmp;
+
+	if (!root) {
+		*success = 0;
+		return NULL;
+	}
+
+	cmp = _compare(prefix, key, root);
+	if (cmp < 0) {
+		root->left = _delete(pTree, root->left, prefix, key, success);
+	}
+	else if (cmp > 0) {
+		root->right = _delete(pTree, root->right, prefix, key, success);
+	}
+	else if (root->right == NULL || root->left == NULL) {
+		NODE *tmp = (root->left) ? root->left : root->right;
+		_freeNode(pTree, root);
+		*success = 1;
+		// the child subtree is already balanced
+		return tmp;
+	}
+	else {
+		// the successor node takes the place of root, so data never moves between nodes
+		NODE *succ;
+		NODE *right = _deleteMin(root->right, &succ);
+		succ->left = root->left;
+		succ->right = right;
+		_freeNode(pTree, root);
+		root = succ;
+		*success = 1;
+	}
+	if (!*success) return root;
+
+	root->height = max(getHeight(root->left), getHeight(root->right)) + 1;
+	if (BALANCING) root = _rebalance(root);
+
+	return root;
+}
+
+/* internal function
+	Detaches the leftmost node of the tree and passes it back in minPtr
+	return	pointer to new root
+*/
+static NODE *_deleteMin( NODE *root, NODE **minPtr) {
+	if (!root->left) {
+		*minPtr = root;
+		return root->right;
+	}
+	root->left = _deleteMin(root->left, minPtr);
+	root->height = max(getHeight(root->left), getHeight(root->right)) + 1;
+	if (BALANCING) root = _rebalance(root);
+
+	return root;
+}
+
+/* Retrieve tree for the node containing the requested key
+	return	address of data of the node containing the key
+			NULL not found
+*/
+char *AVL_Retrieve( AVL_TREE *pTree, char *key) {
+	if (pTree->image) {
+		IMAGE_NODE *foundNode = _retrieveImage(pTree, key);
+		if (foundNode) return pTree->image + foundNode->data;
+	}
+	else if (pTree->root) {
+		NODE *foundNode = _retrieve(pTree->root, key);
+		if (foundNode) return foundNode->data;
+	}
+	return NULL;
+}
+
+/* internal function
+	Retrieve node containing the requested key
+	return	address of the node containing the key
+			NULL not found
+*/
+static NODE *_retrieve( NODE *root, char *key) {
+	unsigned long long prefix = _prefix(key);
+
+	while (root) {
+		int cmp = _compare(prefix, key, root);
+
+		if (cmp == 0) return root;
+		root = (cmp < 0) ? root->left : root->right;
+	}
+	return NULL;
+}
+
+/* internal function
+	Retrieve node of the snapshot image containing the requested key
+	return	address of the image node containing the key
+			NULL not found
+*/
+static IMAGE_NODE *_retrieveImage( AVL_TREE *pTree, char *key) {
+	IMAGE_HEADER *header = (IMAGE_HEADER *) pTree->image;
+	IMAGE_NODE *nodes = (IMAGE_NODE *) (header + 1);
+	unsigned long long prefix = _prefix(key);
+	unsigned int i = header->root;
+
+	// indices, offsets and the number of steps are checked, so a damaged image cannot lead outside of it or loop
+	for (int level = 0; i != 0 && i <= header->count && level < header->height; level++) {
+		IMAGE_NODE *node = &nodes[i - 1];
+		int cmp;
+
+		if (!_imageDataValid(pTree, node)) return NULL;
+		cmp = _compareData(prefix, key, node->prefix, pTree->image + node->data);
+		if (cmp == 0) return node;
+		i = (cmp < 0) ? node->left : node->right;
+	}
+	return NULL;
+}
+
+/* internal function
+	Checks that a comparison can read the string of the image node without leaving the image;
+	the string is read past the cached prefix only if the prefix has no zero byte
+	return	1 if it can be read
+			0 if the image is damaged
+*/
+static int _imageDataValid( AVL_TREE *pTree, IMAGE_NODE *node) {
+	// the image ends with a zero byte, so a string that starts inside it also ends inside it
+	if (node->data >= pTree->imageSize) return 0;
+	return (node->prefix & 0xFF) == 0 || (size_t) node->data + PREFIX_LEN < pTree->imageSize;
+}
+
+/* Counts the insertions of the key
+	return	frequency of the key
+			0 not found
+*/
+int AVL_Frequency( AVL_TREE *pTree, char *key) {
+	NODE *foundNode;
+
+	if (pTree->image) {
+		IMAGE_NODE *imageNode = _retrieveImage(pTree, key);
+		return (imageNode) ? imageNode->freq : 0;
+	}
+	foundNode = _retrieve(pTree->root, key);
+
+	return (foundNode) ? foundNode->freq : 0;
+}
+
+/* Retrieves n keys at once, passing back data of each key (NULL if not found) in results.
+	Up to BATCH_SIZE lookups go down the tree in turns, prefetching the next node of each
+	so that their cache misses overlap
+	return	number of keys found
+*/
+int AVL_RetrieveBatch( AVL_TREE *pTree, char **keys, int n, char **results) {
+	NODE *node[BATCH_SIZE]; // next node of each lookup
+	unsigned long long prefix[BATCH_SIZE];
+	int lane[BATCH_SIZE]; // index of the key of each lookup
+	int active, next = 0, found = 0;
+
+	if (pTree->image) {
+		for (int i = 0; i < n; i++) {
+			if ((results[i] = AVL_Retrieve(pTree, keys[i])) != NULL) found++;
 		}
-		else {
-			return root;
+		return found;
+	}
+	if (!pTree->root) {
+		for (int i = 0; i < n; i++) results[i] = NULL;
+		return 0;
+	}
+
+	for (active = 0; active < BATCH_SIZE && next < n; active++, next++) {
+		lane[active] = next;
+		prefix[active] = _prefix(keys[next]);
+		node[active] = pTree->root;
+	}
+
+	while (active > 0) {
+		for (int i = 0; i < active; i++) {
+			int k = lane[i];
+			int cmp = _compare(prefix[i], keys[k], node[i]);
+
+			if (cmp != 0) {
+				node[i] = (cmp < 0) ? node[i]->left : node[i]->right;
+				if (node[i]) {
+					// the node is read in the next turn, after the other lookups
+					prefetch(node[i]);
+					continue;
+				}
+				results[k] = NULL;
+			}
+			else {
+				results[k] = node[i]->data;
+				found++;
+			}
+
+			// the lookup is done; the lane starts the next key or is closed
+			if (next < n) {
+				lane[i] = next;
+				prefix[i] = _prefix(keys[next]);
+				node[i] = pTree->root;
+				next++;
+			}
+			else {
+				active--;
+				lane[i] = lane[active];
+				prefix[i] = prefix[active];
+				node[i] = node[active];
+				i--;
+			}
 		}
 	}
-	else {
+
+	return found;
+}
+
+/*
+	return	height of the tree
+*/
+int AVL_Height( AVL_TREE *pTree) {
+	if (pTree->image) return ((IMAGE_HEADER *) pTree->image)->height;
+	return getHeight(pTree->root);
+}
+
+/* Writes the tree to a snapshot image file
+	return	1 success
+			0 file error or overflow
+*/
+int AVL_Save( AVL_TREE *pTree, const char *filename) {
+	FILE *fp;
+	IMAGE_HEADER header;
+	IMAGE_NODE *nodes;
+	NODE **queue; // nodes in level order
+	unsigned int tail = 0;
+	size_t offset;
+	int ret;
+
+	if (pTree->image) {
+		if ((fp = fopen(filename, "wb")) == NULL) return 0;
+		ret = fwrite(pTree->image, 1, pTree->imageSize, fp) == pTree->imageSize;
+		return (fclose(fp) == 0 && ret) ? 1 : 0;
+	}
+
+	nodes = (IMAGE_NODE *) malloc (sizeof(IMAGE_NODE) * (pTree->count ? pTree->count : 1));
+	queue = (NODE **) malloc (sizeof(NODE *) * (pTree->count ? pTree->count : 1));
+	if (!nodes || !queue) {
+		free(nodes);
+		free(queue);
+		return 0;
+	}
+
+	// level order keeps the top of the tree together at the start of the image
+	if (pTree->root) queue[tail++] = pTree->root;
+	offset = sizeof(IMAGE_HEADER) + sizeof(IMAGE_NODE) * pTree->count;
+	for (unsigned int i = 0; i < tail; i++) {
+		NODE *node = queue[i];
+
+		if (offset > UINT_MAX) break;
+		nodes[i].prefix = node->prefix;
+		nodes[i].data = offset;
+		nodes[i].freq = node->freq;
+		offset += strlen(node->data) + 1;
+
+		nodes[i].left = nodes[i].right = 0;
+		if (node->left) {
+			queue[tail++] = node->left;
+			nodes[i].left = tail;
+		}
+		if (node->right) {
+			queue[tail++] = node->right;
+			nodes[i].right = tail;
+		}
+	}
+
+	ret = 0;
+	if (offset <= UINT_MAX && (fp = fopen(filename, "wb")) != NULL) {
+		memcpy(header.magic, SNAPSHOT_MAGIC, 4);
+		header.count = pTree->count;
+		header.root = (pTree->root) ? 1 : 0;
+		header.height = getHeight(pTree->root);
+
+		ret = fwrite(&header, sizeof(header), 1, fp) == 1
+			&& fwrite(nodes, sizeof(IMAGE_NODE), tail, fp) == tail;
+		for (unsigned int i = 0; ret && i < tail; i++) {
+			ret = fputs(queue[i]->data, fp) != EOF && fputc('\0', fp) != EOF;
+		}
+		ret = (fclose(fp) == 0 && ret) ? 1 : 0;
+	}
+
+	free(nodes);
+	free(queue);
+	return ret;
+}
+
+/* Maps a snapshot image written by AVL_Save and uses it without rebuilding the tree.
+	The loaded tree is read-only: AVL_Retrieve, AVL_RetrieveBatch, AVL_Frequency, AVL_PrefixTraverse,
+	AVL_Height and AVL_Save read the image; the other functions see an empty tree
+	return	head node pointer
+			NULL if the file is not a snapshot or overflow
+*/
+AVL_TREE *AVL_Load( const char *filename) {
+	int fd = open(filename, O_RDONLY);
+	struct stat st;
+	char *map;
+	IMAGE_HEADER *header;
+	AVL_TREE *pTree;
+
+	if (fd < 0) return NULL;
+	if (fstat(fd, &st) < 0 || (size_t) st.st_size < sizeof(IMAGE_HEADER)) {
+		close(fd);
+		return NULL;
+	}
+	map = (char *) mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) return NULL;
+
+	// the node array must fit in the file and the last string must end in it
+	header = (IMAGE_HEADER *) map;
+	if (memcmp(header->magic, SNAPSHOT_MAGIC, 4) != 0 || header->root > header->count
+		|| header->height < 0 || (unsigned int) header->height > header->count
+		|| header->count > (st.st_size - sizeof(IMAGE_HEADER)) / sizeof(IMAGE_NODE)
+		|| (header->count > 0 && map[st.st_size - 1] != '\0')) {
+		munmap(map, st.st_size);
 		return NULL;
 	}
+
+	pTree = AVL_Create();
+	if (!pTree) {
+		munmap(map, st.st_size);
+		return NULL;
+	}
+	pTree->image = map;
+	pTree->imageSize = st.st_size;
+	pTree->count = header->count;
+
+	return pTree;
+}
+
+/* Prepares the tree for one writer thread calling AVL_InsertShared
+	while up to readers threads call AVL_RetrieveShared without locks.
+	AVL_Insert and AVL_Delete fail on a shared tree
+	return	1 success
+			0 overflow, the tree is a loaded snapshot or already shared
+*/
+int AVL_Share( AVL_TREE *pTree, int readers) {
+	SHARED *shared;
+
+	if (pTree->image || pTree->shared || readers < 1) return 0;
+
+	shared = (SHARED *) aligned_alloc(CACHE_LINE, sizeof(SHARED));
+	if (!shared) return 0;
+	shared->slots = (READER_SLOT *) aligned_alloc(CACHE_LINE, sizeof(READER_SLOT) * readers);
+	if (!shared->slots) {
+		free(shared);
+		return 0;
+	}
+	for (int i = 0; i < readers; i++) shared->slots[i].epoch = 0;
+	shared->epoch = 1;
+	shared->readers = readers;
+	shared->retired = NULL;
+	shared->retiredCount = 0;
+	shared->retiredCapacity = 0;
+	shared->reclaimAt = RECLAIM_BATCH;
+
+	pTree->shared = shared;
+	return 1;
+}
+
+/* Inserts new data like AVL_Insert without changing any node a reader can see:
+	the path from the root is copied, the new root is published atomically
+	and the replaced nodes are retired until no reader can hold them.
+	only one thread may call it at a time
+	return	1 success
+			0 overflow or the tree is not shared
+*/
+int AVL_InsertShared( AVL_TREE *pTree, char *data) {
+	SHARED *shared = pTree->shared;
+	NODE *path[MAX_HEIGHT];
+	NODE *copies[MAX_HEIGHT];
+	char goLeft[MAX_HEIGHT];
+	NODE *node = pTree->root;
+	NODE *child;
+	int top = 0, found = 0;
+	unsigned long epoch;
+	unsigned long long prefix = _prefix(data);
+
+	if (!shared) return 0;
+
+	// only this thread changes root, so it is read without synchronization
+	while (node) {
+		int cmp = _compare(prefix, data, node);
+
+		if (top == MAX_HEIGHT) return 0;
+		path[top] = node;
+		goLeft[top++] = (cmp < 0);
+		if (COUNTING && cmp == 0) {
+			found = 1;
+			break;
+		}
+		node = (cmp < 0) ? node->left : node->right;
+	}
+
+	// room for the retired path is made first, so nothing can fail after publishing
+	if (shared->retiredCount + top > shared->retiredCapacity) {
+		int capacity = max(shared->retiredCapacity * 2, shared->retiredCount + top + RECLAIM_BATCH);
+		RETIRED *retired = (RETIRED *) realloc (shared->retired, sizeof(RETIRED) * capacity);
+		if (!retired) return 0;
+		shared->retired = retired;
+		shared->retiredCapacity = capacity;
+	}
+
+	for (int i = 0; i < top; i++) {
+		if (!(copies[i] = _copyNode(pTree, path[i]))) {
+			while (i > 0) _releaseNode(pTree, copies[--i]);
+			return 0;
+		}
+	}
+	if (found) {
+		child = copies[top - 1];
+		child->freq++;
+	}
+	else if (!(child = _makeNode(pTree, data))) {
+		for (int i = 0; i < top; i++) _releaseNode(pTree, copies[i]);
+		return 0;
+	}
+
+	// the copies are private until the root is published, so they are linked and rotated in place;
+	// a rotation only moves nodes of the path, which are all copies
+	for (int i = top - 1 - found; i >= 0; i--) {
+		node = copies[i];
+		if (goLeft[i]) node->left = child;
+		else node->right = child;
+		node->height = max(getHeight(node->left), getHeight(node->right)) + 1;
+		child = BALANCING ? _rebalance(node) : node;
+	}
+
+	// a reader that loads the root after this sees only the new path
+	__atomic_store_n(&pTree->root, child, __ATOMIC_SEQ_CST);
+	pTree->count += !found;
+
+	epoch = __atomic_load_n(&shared->epoch, __ATOMIC_RELAXED);
+	for (int i = 0; i < top; i++) {
+		shared->retired[shared->retiredCount].node = path[i];
+		shared->retired[shared->retiredCount].epoch = epoch;
+		shared->retiredCount++;
+	}
+	if (shared->retiredCount >= shared->reclaimAt) {
+		_reclaim(pTree);
+		shared->reclaimAt = shared->retiredCount + RECLAIM_BATCH;
+	}
+
+	return 1;
+}
+
+/* Retrieve like AVL_Retrieve, safe while AVL_InsertShared runs in another thread
+	reader is the slot of the calling thread (0 ~ readers - 1); no two threads use the same slot
+	return	address of data of the node containing the key (valid until the tree is destroyed)
+			NULL not found
+*/
+char *AVL_RetrieveShared( AVL_TREE *pTree, int reader, char *key) {
+	READER_SLOT *slot = &pTree->shared->slots[reader];
+	NODE *foundNode;
+	char *data;
+
+	// the epoch is announced before the root is loaded, so the writer cannot free any node reached from it
+	__atomic_store_n(&slot->epoch, __atomic_load_n(&pTree->shared->epoch, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+	foundNode = _retrieve(__atomic_load_n(&pTree->root, __ATOMIC_SEQ_CST), key);
+	data = foundNode ? foundNode->data : NULL; // the node may be freed once the slot is released
+	__atomic_store_n(&slot->epoch, 0, __ATOMIC_RELEASE);
+
+	// strings are never freed while the tree exists
+	return data;
+}
+
+/* internal function
+	Allocates a copy of the node that shares its string
+	return	new node
+			NULL if overflow
+*/
+static NODE *_copyNode( AVL_TREE *pTree, NODE *node) {
+	NODE *newNode;
+
+	if (ARENA) newNode = (NODE *) _arenaAlloc(pTree, sizeof(NODE));
+	else newNode = (NODE *) malloc (sizeof(NODE));
+	if (!newNode) return NULL;
+
+	*newNode = *node;
+	return newNode;
+}
+
+/* internal function
+	Frees a node whose string belongs to another node (a copy or a replaced node)
+*/
+static void _releaseNode( AVL_TREE *pTree, NODE *node) {
+	if (!ARENA) {
+		free(node);
+		return;
+	}
+	// a node made by _makeNode holds the string of its copies, so it stays in its block
+	if (node->data != (char *) (node + 1)) {
+		size_t size = (sizeof(NODE) + ARENA_ALIGN - 1) / ARENA_ALIGN;
+
+		node->left = pTree->freeList[size];
+		pTree->freeList[size] = node;
+	}
+}
+
+/* internal function
+	Advances the epoch and frees the retired nodes that no reader can hold any more
+*/
+static void _reclaim( AVL_TREE *pTree) {
+	SHARED *shared = pTree->shared;
+	unsigned long oldest;
+	int freed = 0;
+
+	// a reader that enters from now on loads the current root, which reaches no retired node
+	oldest = __atomic_add_fetch(&shared->epoch, 1, __ATOMIC_SEQ_CST);
+	for (int i = 0; i < shared->readers; i++) {
+		unsigned long epoch = __atomic_load_n(&shared->slots[i].epoch, __ATOMIC_SEQ_CST);
+		if (epoch != 0 && epoch < oldest) oldest = epoch;
+	}
+
+	// a node retired in an epoch before every reader's epoch was replaced before they loaded the root
+	while (freed < shared->retiredCount && shared->retired[freed].epoch < oldest) {
+		_releaseNode(pTree, shared->retired[freed].node);
+		freed++;
+	}
+	shared->retiredCount -= freed;
+	memmove(shared->retired, shared->retired + freed, sizeof(RETIRED) * shared->retiredCount);
 }
 
 /* Prints tree using inorder traversal
@@ -348,6 +1520,114 @@ static void _traverse( NODE *root) {
 	}
 }
 
+/* Visits nodes whose data lies in [lo, hi] in ascending order
+	subtrees entirely outside the range are not visited
+*/
+void AVL_RangeTraverse( AVL_TREE *pTree, char *lo, char *hi, void (*callback)(char *data)) {
+	if (pTree->root && strcmp(lo, hi) <= 0) {
+		_rangeTraverse(pTree->root, _prefix(lo), lo, _prefix(hi), hi, callback);
+	}
+}
+static void _rangeTraverse( NODE *root, unsigned long long loPrefix, char *lo,
+	unsigned long long hiPrefix, char *hi, void (*callback)(char *data)) {
+	int geLo, leHi;
+
+	if (!root) return;
+
+	// rotations can move keys equal to root to either side
+	geLo = _compare(loPrefix, lo, root) <= 0;
+	leHi = _compare(hiPrefix, hi, root) >= 0;
+
+	if (geLo) {
+		_rangeTraverse(root->left, loPrefix, lo, hiPrefix, hi, callback);
+	}
+	if (geLo && leHi) {
+		callback(root->data);
+	}
+	if (leHi) {
+		_rangeTraverse(root->right, loPrefix, lo, hiPrefix, hi, callback);
+	}
+}
+
+/* Visits nodes whose data starts with prefix in ascending order
+	subtrees without such data are not visited
+*/
+void AVL_PrefixTraverse( AVL_TREE *pTree, char *prefix, void (*callback)(char *data)) {
+	int len = strlen(prefix);
+	int cached = (len < PREFIX_LEN) ? len : PREFIX_LEN;
+	unsigned long long mask = (cached == 0) ? 0 : ~0ULL << (8 * (PREFIX_LEN - cached));
+
+	if (pTree->image) {
+		_prefixTraverseImage(pTree, ((IMAGE_HEADER *) pTree->image)->root, 0, _prefix(prefix), mask, prefix, len, callback);
+	}
+	else if (pTree->root) {
+		_prefixTraverse(pTree->root, _prefix(prefix), mask, prefix, len, callback);
+	}
+}
+static void _prefixTraverse( NODE *root, unsigned long long keyPrefix, unsigned long long mask,
+	char *prefix, int len, void (*callback)(char *data)) {
+	int cmp;
+
+	if (!root) return;
+
+	// data with the prefix are contiguous in order; cmp < 0 before them, cmp > 0 after them
+	cmp = _comparePrefix(keyPrefix, mask, prefix, len, root->prefix, root->data);
+
+	if (cmp >= 0) {
+		_prefixTraverse(root->left, keyPrefix, mask, prefix, len, callback);
+	}
+	if (cmp == 0) {
+		callback(root->data);
+	}
+	if (cmp <= 0) {
+		_prefixTraverse(root->right, keyPrefix, mask, prefix, len, callback);
+	}
+}
+static void _prefixTraverseImage( AVL_TREE *pTree, unsigned int i, int level, unsigned long long keyPrefix,
+	unsigned long long mask, char *prefix, int len, void (*callback)(char *data)) {
+	IMAGE_HEADER *header = (IMAGE_HEADER *) pTree->image;
+	IMAGE_NODE *node;
+	int cmp;
+
+	// the same checks as _retrieveImage keep a damaged image from leading outside of it or looping
+	if (i == 0 || i > header->count || level >= header->height) return;
+	node = &((IMAGE_NODE *) (header + 1))[i - 1];
+	if (!_imageDataValid(pTree, node)) return;
+
+	cmp = _comparePrefix(keyPrefix, mask, prefix, len, node->prefix, pTree->image + node->data);
+
+	if (cmp >= 0) {
+		_prefixTraverseImage(pTree, node->left, level + 1, keyPrefix, mask, prefix, len, callback);
+	}
+	if (cmp == 0) {
+		callback(pTree->image + node->data);
+	}
+	if (cmp <= 0) {
+		_prefixTraverseImage(pTree, node->right, level + 1, keyPrefix, mask, prefix, len, callback);
+	}
+}
+
+/* Seeks the smallest key not less than key
+	return	address of data of the node
+			NULL if all keys are less than key
+*/
+char *AVL_LowerBound( AVL_TREE *pTree, char *key) {
+	unsigned long long prefix = _prefix(key);
+	NODE *node = pTree->root;
+	NODE *found = NULL;
+
+	while (node) {
+		if (_compare(prefix, key, node) <= 0) {
+			// node is a candidate; a smaller one can only be on the left
+			found = node;
+			node = node->left;
+		}
+		else node = node->right;
+	}
+
+	return (found) ? found->data : NULL;
+}
+
 /* Prints tree using inorder right-to-left traversal
 */
 void printTree( AVL_TREE *pTree) {
@@ -372,6 +1652,13 @@ static void _infix_print( NODE *root, int level) {
     }
 }
 
+/* Prints data followed by a space
+	callback of AVL_RangeTraverse and AVL_PrefixTraverse
+*/
+static void printWord( char *data) {
+	printf("%s ", data);
+}
+
 /* internal function
 	return	height of the (sub)tree from the node (root)
 */
@@ -379,6 +1666,42 @@ static int getHeight( NODE *root) {
 	return (!root) ? 0 : root->height;
 }
 
+/* internal function
+	Compares the key with data of the node,
+	reading the strings only if the prefixes are the same
+	return	negative, 0 or positive like strcmp
+*/
+static int _compare( unsigned long long prefix, const char *key, NODE *node) {
+	return _compareData(prefix, key, node->prefix, node->data);
+}
+
+/* internal function
+	Compares the key with data whose prefix is dataPrefix,
+	reading the strings only if the prefixes are the same
+	return	negative, 0 or positive like strcmp
+*/
+static int _compareData( unsigned long long prefix, const char *key, unsigned long long dataPrefix, const char *data) {
+	if (prefix != dataPrefix) return (prefix < dataPrefix) ? -1 : 1;
+	// a zero last byte means both strings end inside the prefix
+	if ((prefix & 0xFF) == 0) return 0;
+	return strcmp(key + PREFIX_LEN, data + PREFIX_LEN);
+}
+
+/* internal function
+	Compares the first len bytes of data whose prefix is dataPrefix with prefix (len bytes),
+	reading the string only if the cached prefixes are the same
+	mask selects the first len bytes of a cached prefix
+	return	negative, 0 or positive like strncmp
+*/
+static int _comparePrefix( unsigned long long keyPrefix, unsigned long long mask,
+	const char *prefix, int len, unsigned long long dataPrefix, const char *data) {
+	dataPrefix &= mask;
+
+	if (dataPrefix != keyPrefix) return (dataPrefix < keyPrefix) ? -1 : 1;
+	if (len <= PREFIX_LEN) return 0;
+	return strncmp(data + PREFIX_LEN, prefix + PREFIX_LEN, len - PREFIX_LEN);
+}
+
 /* internal function
 	Exchanges pointers to rotate the tree to the right
 	updates heights of the nodes
@@ -423,4 +1746,273 @@ case 2: right of right
 case 3: right of left
 
 case 4: left of right
-*/
\ No newline at end of file
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+// Benchmark mode
+
+/*
+	return	1 if words are sorted by strcmp; 0 if not
+*/
+static int _isSorted( char **words, int n) {
+	for (int i = 1; i < n; i++) {
+		if (strcmp(words[i - 1], words[i]) > 0) return 0;
+	}
+	return 1;
+}
+
+static unsigned long long rngState = 0x9E3779B97F4A7C15ULL;
+
+/* xorshift64* pseudo random number generator
+	return	32 random bits
+*/
+static unsigned int _random( void) {
+	rngState ^= rngState >> 12;
+	rngState ^= rngState << 25;
+	rngState ^= rngState >> 27;
+	return (unsigned int) ((rngState * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+/* Inserts all words, then deletes or reinserts a random word n times
+	and reports throughput, tree height and number of nodes
+	return	0 success
+			1 overflow or tree corrupted
+*/
+static int churn( char **words, int count, int n) {
+	AVL_TREE *tree = AVL_Create();
+	char *present = (char *) malloc (count ? count : 1); // 1 if words[i] is in the tree
+	int live = count, inserts = 0, deletes = 0;
+	clock_t start;
+	double sec;
+
+	if (!tree || !present) {
+		fprintf( stderr, "Cannot allocate benchmark data!\n");
+		return 1;
+	}
+
+	start = clock();
+	for (int i = 0; i < count; i++) {
+		if (!AVL_Insert( tree, words[i])) {
+			fprintf( stderr, "Cannot insert into the tree!\n");
+			return 1;
+		}
+		present[i] = 1;
+	}
+	sec = (double) (clock() - start) / CLOCKS_PER_SEC;
+	fprintf( stdout, "Insert: %d words, %.3f sec (%.0f ops/sec)\n", count, sec, count / (sec > 0 ? sec : 1e-9));
+	fprintf( stdout, "Height of tree: %d\n", getHeight( tree->root));
+
+	start = clock();
+	for (int i = 0; i < n && count > 0; i++) {
+		int j = _random() % count;
+
+		if (present[j]) {
+			if (!AVL_Delete( tree, words[j])) {
+				fprintf( stderr, "%s NOT found!\n", words[j]);
+				return 1;
+			}
+			deletes++;
+			live--;
+		}
+		else {
+			if (!AVL_Insert( tree, words[j])) {
+				fprintf( stderr, "Cannot insert into the tree!\n");
+				return 1;
+			}
+			inserts++;
+			live++;
+		}
+		present[j] ^= 1;
+	}
+	sec = (double) (clock() - start) / CLOCKS_PER_SEC;
+	fprintf( stdout, "Churn: %d inserts, %d deletes, %.3f sec (%.0f ops/sec)\n", inserts, deletes, sec,
+		n / (sec > 0 ? sec : 1e-9));
+	fprintf( stdout, "Height of tree: %d\n", getHeight( tree->root));
+	fprintf( stdout, "# of nodes: %d\n", tree->count);
+
+	// with COUNTING, a word that appears twice in the file shares one node
+	if (!COUNTING && tree->count != live) {
+		fprintf( stderr, "Tree corrupted!\n");
+		return 1;
+	}
+
+	AVL_Destroy( tree);
+	free(present);
+	return 0;
+}
+
+/* Looks up all keys with AVL_RetrieveBatch and prints the results,
+	then reports time per key against one AVL_Retrieve per key
+	both methods get an untimed warm-up pass, then BATCH_ROUNDS timed passes in alternating order
+	return	0 success
+			1 overflow or results differ
+*/
+static int batchQuery( AVL_TREE *tree, char **keys, int n) {
+	char **results = (char **) malloc (sizeof(char *) * (n ? n : 1));
+	clock_t start;
+	double batchSec, singleSec;
+	int found;
+
+	if (!results) {
+		fprintf( stderr, "Cannot allocate benchmark data!\n");
+		return 1;
+	}
+
+	// warm-up: both methods run once untimed, so neither pays for the first touch of the tree
+	found = AVL_RetrieveBatch( tree, keys, n, results);
+	for (int i = 0; i < n; i++) {
+		if (AVL_Retrieve( tree, keys[i]) != results[i]) {
+			fprintf( stderr, "Results differ! [%s]\n", keys[i]);
+			free(results);
+			return 1;
+		}
+	}
+
+	// alternating order, so that neither method always runs right after the other
+	batchSec = singleSec = 0.0;
+	for (int round = 0; round < BATCH_ROUNDS; round++) {
+		for (int pass = 0; pass < 2; pass++) {
+			start = clock();
+			if ((round + pass) % 2 == 0) {
+				AVL_RetrieveBatch( tree, keys, n, results);
+				batchSec += (double) (clock() - start) / CLOCKS_PER_SEC;
+			}
+			else {
+				for (int i = 0; i < n; i++) AVL_Retrieve( tree, keys[i]);
+				singleSec += (double) (clock() - start) / CLOCKS_PER_SEC;
+			}
+		}
+	}
+
+	for (int i = 0; i < n; i++) {
+		if (results[i]) fprintf( stdout, "%s found!\n", results[i]);
+		else fprintf( stdout, "%s NOT found!\n", keys[i]);
+	}
+
+	fprintf( stderr, "%d queries, %d found\n", n, found);
+	fprintf( stderr, "Batch: %.1f ns/query, one by one: %.1f ns/query\n",
+		n ? batchSec * 1e9 / n / BATCH_ROUNDS : 0.0, n ? singleSec * 1e9 / n / BATCH_ROUNDS : 0.0);
+
+	free(results);
+	return 0;
+}
+
+// argument and result of a thread of readScaling
+typedef struct
+{
+	AVL_TREE	*tree;
+	char		**words;
+	int			count;
+	int			slot; // reader slot (unused by the writer)
+	int			*stop; // set to 1 when the run is over
+	long long	done; // lookups of a reader; insertions of the writer
+	int			missing; // even words a reader did not find
+} THREAD_ARG;
+
+/* reader thread of readScaling
+	looks up random even words, which are in the tree all the time
+*/
+static void *_reader( void *arg) {
+	THREAD_ARG *t = (THREAD_ARG *) arg;
+	unsigned long long state = 0x9E3779B97F4A7C15ULL * (t->slot + 1); // xorshift64 of its own
+	int half = (t->count + 1) / 2;
+
+	while (!__atomic_load_n(t->stop, __ATOMIC_RELAXED)) {
+		for (int i = 0; i < 1024; i++) {
+			state ^= state >> 12;
+			state ^= state << 25;
+			state ^= state >> 27;
+			if (!AVL_RetrieveShared( t->tree, t->slot, t->words[(int) ((state >> 32) % half) * 2])) t->missing++;
+		}
+		t->done += 1024;
+	}
+	return NULL;
+}
+
+/* writer thread of readScaling
+	inserts the odd words until all are in or the run is over
+*/
+static void *_writer( void *arg) {
+	THREAD_ARG *t = (THREAD_ARG *) arg;
+
+	for (int i = 1; i < t->count && !__atomic_load_n(t->stop, __ATOMIC_RELAXED); i += 2) {
+		if (!AVL_InsertShared( t->tree, t->words[i])) {
+			t->missing++;
+			break;
+		}
+		t->done++;
+	}
+	return NULL;
+}
+
+/* For 1, 2, 4 ~ threads readers: builds a tree of the even words, then runs the readers
+	for READ_MSEC while one writer inserts the odd words with AVL_InsertShared,
+	and reports lookups per second of all readers
+	return	0 success
+			1 overflow or a word went missing
+*/
+static int readScaling( char **words, int count, int threads) {
+	THREAD_ARG *args = (THREAD_ARG *) malloc (sizeof(THREAD_ARG) * (threads + 1));
+	pthread_t *tid = (pthread_t *) malloc (sizeof(pthread_t) * (threads + 1));
+	struct timespec pause = { READ_MSEC / 1000, READ_MSEC % 1000 * 1000000L };
+
+	if (!args || !tid || count < 2) {
+		fprintf( stderr, "Cannot allocate benchmark data!\n");
+		free(args);
+		free(tid);
+		return 1;
+	}
+
+	fprintf( stdout, "%8s %14s %14s %10s\n", "readers", "lookups/sec", "per reader", "inserts");
+	for (int readers = 1; readers <= threads; readers = (readers < threads && readers * 2 > threads) ? threads : readers * 2) {
+		AVL_TREE *tree = AVL_Create();
+		struct timespec start, end;
+		long long lookups = 0;
+		int stop = 0, missing = 0;
+		double sec;
+
+		for (int i = 0; tree && i < count; i += 2) {
+			if (!AVL_Insert( tree, words[i])) {
+				AVL_Destroy( tree);
+				tree = NULL;
+			}
+		}
+		if (!tree || !AVL_Share( tree, readers)) {
+			fprintf( stderr, "Cannot create tree!\n");
+			return 1;
+		}
+
+		for (int i = 0; i <= readers; i++) {
+			args[i] = (THREAD_ARG) { tree, words, count, i, &stop, 0, 0 };
+		}
+		clock_gettime( CLOCK_MONOTONIC, &start);
+		pthread_create( &tid[readers], NULL, _writer, &args[readers]);
+		for (int i = 0; i < readers; i++) pthread_create( &tid[i], NULL, _reader, &args[i]);
+		nanosleep( &pause, NULL);
+		__atomic_store_n(&stop, 1, __ATOMIC_RELAXED);
+		for (int i = 0; i <= readers; i++) pthread_join( tid[i], NULL);
+		clock_gettime( CLOCK_MONOTONIC, &end);
+		sec = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+		for (int i = 0; i < readers; i++) {
+			lookups += args[i].done;
+			missing += args[i].missing;
+		}
+		// every word the writer inserted must be found once it is done
+		for (int i = 1; i < count && i / 2 < args[readers].done; i += 2) {
+			if (!AVL_Retrieve( tree, words[i])) missing++;
+		}
+		missing += args[readers].missing;
+		fprintf( stdout, "%8d %14.0f %14.0f %10lld\n", readers, lookups / sec, lookups / sec / readers, args[readers].done);
+		AVL_Destroy( tree);
+
+		if (missing) {
+			fprintf( stderr, "%d words missing!\n", missing);
+			return 1;
+		}
+	}
+
+	free(args);
+	free(tid);
+	return 0;
+}
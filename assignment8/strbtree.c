@@ -0,0 +1,442 @@
+#define SHOW_STEP 0 // 제출시 0
+
+#include <stdlib.h> // malloc
+#include <stdio.h>
+#include <string.h> //strcmp, strdup
+#include <time.h> // clock
+#include "strword.h" // _prefix, _readWords, PREFIX_LEN
+
+#define MAX_KEYS	9 // keys per node; a node is 240 bytes, allocated as 4 cache lines
+#define CACHE_LINE	64 // nodes start at a cache line boundary
+
+////////////////////////////////////////////////////////////////////////////////
+// B+-tree type definition
+// all keys are in the leaves, which are linked in sorted order;
+// keys of internal nodes only guide the search and point to strings of the leaves
+typedef struct bnode
+{
+	int				count; // number of keys
+	int				leaf; // 1 if leaf node
+	unsigned long long	prefix[MAX_KEYS]; // first PREFIX_LEN bytes of keys, big-endian and zero padded
+	char			*key[MAX_KEYS];
+	struct bnode	*child[MAX_KEYS + 1]; // internal node only
+	struct bnode	*next; // next leaf in sorted order (leaf only)
+} BNODE;
+
+typedef struct
+{
+	BNODE	*root;
+	int		count; // number of keys
+	int		height; // number of levels
+	int		nodes; // number of nodes
+} BTREE;
+
+////////////////////////////////////////////////////////////////////////////////
+// Prototype declarations
+
+/* Allocates dynamic memory for a BTREE head node and returns its address to caller
+	return	head node pointer
+			NULL if overflow
+*/
+BTREE *BT_Create( void);
+
+/* Deletes all data in tree and recycles memory
+*/
+void BT_Destroy( BTREE *pTree);
+static void _destroy( BNODE *root);
+
+/* Inserts new data into the tree
+	equal keys are placed after the existing ones
+	return	1 success
+			0 overflow (the tree is not changed)
+*/
+int BT_Insert( BTREE *pTree, char *data);
+
+/* internal function
+	Splits the full child of parent at index into two nodes
+	and inserts the key between them into parent (parent is not full)
+	return	1 success
+			0 overflow
+*/
+static int _split( BTREE *pTree, BNODE *parent, int index);
+
+static BNODE *_makeNode( int leaf);
+
+/* Retrieve tree for the key
+	return	address of data of the leaf containing the key
+			NULL not found
+*/
+char *BT_Retrieve( BTREE *pTree, char *key);
+
+/* Prints tree using the leaf links
+*/
+void BT_Traverse( BTREE *pTree);
+
+/* internal function
+	Binary search over the keys of the node,
+	reading the strings only if the prefixes are the same
+	return	index of the first key greater than the key (count if none)
+*/
+static int _upperBound( BNODE *node, unsigned long long prefix, const char *key);
+
+////////////////////////////////////////////////////////////////////////////////
+// Benchmark mode
+
+/* Looks up all keys one by one with BT_Retrieve
+	and reports time per key
+	return	0 success
+*/
+static int query( BTREE *tree, char **keys, int n);
+
+////////////////////////////////////////////////////////////////////////////////
+int main( int argc, char **argv)
+{
+	BTREE *tree;
+	char str[1024];
+	char *file = argv[1];
+	char *queryFile = NULL;
+	char **words;
+	int count;
+	clock_t start;
+
+	if (argc == 4 && strcmp( argv[1], "-q") == 0)
+	{
+		file = argv[2];
+		queryFile = argv[3];
+	}
+	else if (argc != 2)
+	{
+		fprintf( stderr, "Usage: %s FILE\n", argv[0]);
+		fprintf( stderr, "       %s -q FILE QUERY_FILE\n", argv[0]);
+		return 0;
+	}
+
+	FILE *fp = fopen( file, "rt");
+	if (fp == NULL)
+	{
+		fprintf( stderr, "Cannot open file! [%s]\n", file);
+		return 200;
+	}
+	words = _readWords( fp, &count);
+	fclose( fp);
+	if (!words)
+	{
+		fprintf( stderr, "Cannot read words!\n");
+		return 100;
+	}
+
+	// creates a null tree
+	tree = BT_Create();
+
+	if (!tree)
+	{
+		fprintf( stderr, "Cannot create tree!\n");
+		return 100;
+	}
+
+	start = clock();
+	for (int i = 0; i < count; i++)
+	{
+#if SHOW_STEP
+		fprintf( stdout, "Insert %s>\n", words[i]);
+#endif
+		if (!BT_Insert( tree, words[i]))
+		{
+			fprintf( stderr, "Cannot insert into the tree!\n");
+			return 100;
+		}
+	}
+	if (queryFile)
+	{
+		double sec = (double) (clock() - start) / CLOCKS_PER_SEC;
+		fprintf( stderr, "Insert: %.1f ns/word\n", count ? sec * 1e9 / count : 0.0);
+	}
+
+	for (int i = 0; i < count; i++) free(words[i]);
+	free(words);
+
+#if SHOW_STEP
+	fprintf( stdout, "\n");
+
+	// inorder traversal
+	fprintf( stdout, "Inorder traversal: ");
+	BT_Traverse( tree);
+	fprintf( stdout, "\n");
+#endif
+
+	fprintf( stdout, "Height of tree: %d\n", tree->height);
+	fprintf( stdout, "# of keys: %d\n", tree->count);
+	fprintf( stdout, "# of nodes: %d (%zu bytes each)\n", tree->nodes, sizeof(BNODE));
+
+	// bulk retrieval
+	if (queryFile)
+	{
+		if ((fp = fopen( queryFile, "rt")) == NULL)
+		{
+			fprintf( stderr, "Cannot open file! [%s]\n", queryFile);
+			return 200;
+		}
+		words = _readWords( fp, &count);
+		fclose( fp);
+		if (!words)
+		{
+			fprintf( stderr, "Cannot read words!\n");
+			return 100;
+		}
+		query( tree, words, count);
+		for (int i = 0; i < count; i++) free(words[i]);
+		free(words);
+		BT_Destroy( tree);
+		return 0;
+	}
+
+	// retrieval
+	char *key;
+	fprintf( stdout, "Query: ");
+	while( fscanf( stdin, "%1023s", str) != EOF)
+	{
+		key = BT_Retrieve( tree, str);
+
+		if (key) fprintf( stdout, "%s found!\n", key);
+		else fprintf( stdout, "%s NOT found!\n", str);
+
+		fprintf( stdout, "Query: ");
+	}
+
+	// destroy tree
+	BT_Destroy( tree);
+
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/* Allocates dynamic memory for a BTREE head node and returns its address to caller
+	return	head node pointer
+			NULL if overflow
+*/
+BTREE *BT_Create( void) {
+	BTREE *newTree = (BTREE *) malloc (sizeof(BTREE));
+	if (!newTree) return NULL;
+
+	newTree->root = NULL;
+	newTree->count = 0;
+	newTree->height = 0;
+	newTree->nodes = 0;
+
+	return newTree;
+}
+
+/* Deletes all data in tree and recycles memory
+*/
+void BT_Destroy( BTREE *pTree) {
+	if (pTree->root) {
+		_destroy(pTree->root);
+	}
+	free(pTree);
+}
+static void _destroy( BNODE *root) {
+	if (root->leaf) {
+		// strings are owned by the leaves
+		for (int i = 0; i < root->count; i++) free(root->key[i]);
+	}
+	else {
+		for (int i = 0; i <= root->count; i++) _destroy(root->child[i]);
+	}
+	free(root);
+}
+
+/* Inserts new data into the tree
+	equal keys are placed after the existing ones
+	return	1 success
+			0 overflow (the tree is not changed)
+*/
+int BT_Insert( BTREE *pTree, char *data) {
+	unsigned long long prefix = _prefix(data);
+	BNODE *node;
+	char *newKey;
+	int i;
+
+	if (!pTree->root) {
+		if (!(pTree->root = _makeNode(1))) return 0;
+		pTree->height = 1;
+		pTree->nodes = 1;
+	}
+
+	// a full root is split first, so the tree grows at the top
+	if (pTree->root->count == MAX_KEYS) {
+		BNODE *newRoot = _makeNode(0);
+		if (!newRoot) return 0;
+		newRoot->child[0] = pTree->root;
+		if (!_split(pTree, newRoot, 0)) {
+			free(newRoot);
+			return 0;
+		}
+		pTree->root = newRoot;
+		pTree->height++;
+		pTree->nodes++;
+	}
+
+	// full nodes on the way down are split before entering them,
+	// so a split never has to go back up to a full parent
+	node = pTree->root;
+	while (!node->leaf) {
+		i = _upperBound(node, prefix, data);
+		if (node->child[i]->count == MAX_KEYS) {
+			if (!_split(pTree, node, i)) return 0;
+			if (_upperBound(node, prefix, data) > i) i++;
+		}
+		node = node->child[i];
+	}
+
+	if (!(newKey = strdup(data))) return 0;
+
+	i = _upperBound(node, prefix, data);
+	memmove(&node->prefix[i + 1], &node->prefix[i], sizeof(node->prefix[0]) * (node->count - i));
+	memmove(&node->key[i + 1], &node->key[i], sizeof(node->key[0]) * (node->count - i));
+	node->prefix[i] = prefix;
+	node->key[i] = newKey;
+	node->count++;
+	pTree->count++;
+
+	return 1;
+}
+
+/* internal function
+	Splits the full child of parent at index into two nodes
+	and inserts the key between them into parent (parent is not full)
+	return	1 success
+			0 overflow
+*/
+static int _split( BTREE *pTree, BNODE *parent, int index) {
+	BNODE *left = parent->child[index];
+	BNODE *right = _makeNode(left->leaf);
+	int half = MAX_KEYS / 2;
+	unsigned long long upPrefix;
+	char *upKey;
+
+	if (!right) return 0;
+
+	if (left->leaf) {
+		// the first key of the right leaf is copied up
+		right->count = MAX_KEYS - half;
+		memcpy(right->prefix, &left->prefix[half], sizeof(left->prefix[0]) * right->count);
+		memcpy(right->key, &left->key[half], sizeof(left->key[0]) * right->count);
+		right->next = left->next;
+		left->next = right;
+		left->count = half;
+		upPrefix = right->prefix[0];
+		upKey = right->key[0];
+	}
+	else {
+		// the middle key moves up
+		right->count = MAX_KEYS - half - 1;
+		memcpy(right->prefix, &left->prefix[half + 1], sizeof(left->prefix[0]) * right->count);
+		memcpy(right->key, &left->key[half + 1], sizeof(left->key[0]) * right->count);
+		memcpy(right->child, &left->child[half + 1], sizeof(left->child[0]) * (right->count + 1));
+		left->count = half;
+		upPrefix = left->prefix[half];
+		upKey = left->key[half];
+	}
+
+	memmove(&parent->prefix[index + 1], &parent->prefix[index], sizeof(parent->prefix[0]) * (parent->count - index));
+	memmove(&parent->key[index + 1], &parent->key[index], sizeof(parent->key[0]) * (parent->count - index));
+	memmove(&parent->child[index + 2], &parent->child[index + 1], sizeof(parent->child[0]) * (parent->count - index));
+	parent->prefix[index] = upPrefix;
+	parent->key[index] = upKey;
+	parent->child[index + 1] = right;
+	parent->count++;
+	pTree->nodes++;
+
+	return 1;
+}
+
+static BNODE *_makeNode( int leaf) {
+	BNODE *newNode = (BNODE *) aligned_alloc (CACHE_LINE, (sizeof(BNODE) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE);
+	if (!newNode) return NULL;
+
+	newNode->count = 0;
+	newNode->leaf = leaf;
+	newNode->next = NULL;
+	return newNode;
+}
+
+/* Retrieve tree for the key
+	return	address of data of the leaf containing the key
+			NULL not found
+*/
+char *BT_Retrieve( BTREE *pTree, char *key) {
+	unsigned long long prefix = _prefix(key);
+	BNODE *node = pTree->root;
+	int i;
+
+	if (!node) return NULL;
+
+	// a key equal to a key of an internal node is in the right subtree
+	while (!node->leaf) {
+		node = node->child[_upperBound(node, prefix, key)];
+	}
+
+	i = _upperBound(node, prefix, key);
+	if (i > 0 && node->prefix[i - 1] == prefix && strcmp(node->key[i - 1], key) == 0) return node->key[i - 1];
+
+	return NULL;
+}
+
+/* Prints tree using the leaf links
+*/
+void BT_Traverse( BTREE *pTree) {
+	BNODE *node = pTree->root;
+
+	if (!node) return;
+	while (!node->leaf) node = node->child[0];
+
+	for (; node; node = node->next) {
+		for (int i = 0; i < node->count; i++) printf("%s ", node->key[i]);
+	}
+}
+
+/* internal function
+	Binary search over the keys of the node,
+	reading the strings only if the prefixes are the same
+	return	index of the first key greater than the key (count if none)
+*/
+static int _upperBound( BNODE *node, unsigned long long prefix, const char *key) {
+	int lo = 0, hi = node->count;
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		int greater;
+
+		if (node->prefix[mid] != prefix) greater = node->prefix[mid] > prefix;
+		// a zero last byte means both strings end inside the prefix
+		else if ((prefix & 0xFF) == 0) greater = 0;
+		else greater = strcmp(node->key[mid] + PREFIX_LEN, key + PREFIX_LEN) > 0;
+
+		if (greater) hi = mid;
+		else lo = mid + 1;
+	}
+	return lo;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Benchmark mode
+
+/* Looks up all keys one by one with BT_Retrieve
+	and reports time per key
+	return	0 success
+*/
+static int query( BTREE *tree, char **keys, int n) {
+	clock_t start = clock();
+	double sec;
+	int found = 0;
+
+	for (int i = 0; i < n; i++) {
+		if (BT_Retrieve( tree, keys[i])) found++;
+	}
+	sec = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+	fprintf( stderr, "%d queries, %d found\n", n, found);
+	fprintf( stderr, "Lookup: %.1f ns/query\n", n ? sec * 1e9 / n : 0.0);
+
+	return 0;
+}
@@ -0,0 +1,58 @@
+#ifndef STRWORD_H
+#define STRWORD_H
+
+#include <stdlib.h> // malloc, realloc
+#include <stdio.h>
+#include <string.h> // strdup
+
+// word helpers shared by stravlt.c and strbtree.c
+
+#define PREFIX_LEN	8 // bytes of the key cached in a node
+
+/* internal function
+	Packs the first PREFIX_LEN bytes of the key into an integer
+	so that integers compare in the same order as the strings
+	return	prefix of the key
+*/
+static unsigned long long _prefix( const char *key) {
+	unsigned long long prefix = 0;
+
+	for (int i = 0; i < PREFIX_LEN; i++) {
+		prefix <<= 8;
+		if (*key) prefix |= (unsigned char) *key++;
+	}
+	return prefix;
+}
+
+/* Reads all words of the file into a dynamic array
+	return	array of words (number of words in n)
+			NULL if overflow
+*/
+static char **_readWords( FILE *fp, int *n) {
+	int capacity = 1024;
+	char **words = (char **) malloc (sizeof(char *) * capacity);
+	char str[1024];
+
+	*n = 0;
+	if (!words) return NULL;
+
+	while (fscanf( fp, "%1023s", str) != EOF) {
+		if (*n == capacity) {
+			char **newWords = (char **) realloc (words, sizeof(char *) * capacity * 2);
+			if (!newWords) break;
+			words = newWords;
+			capacity *= 2;
+		}
+		if (!(words[*n] = strdup(str))) break;
+		(*n)++;
+	}
+	if (!feof( fp)) {
+		for (int i = 0; i < *n; i++) free(words[i]);
+		free(words);
+		return NULL;
+	}
+
+	return words;
+}
+
+#endif